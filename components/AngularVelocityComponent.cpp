@@ -0,0 +1,81 @@
+#include "AngularVelocityComponent.hpp"
+
+#include "../core/BaseMessage.hpp"
+#include "../core/ComponentRegistry.hpp"
+#include "../core/TransformStorage.hpp"
+#include "../messages/SetAngularVelocityMessage.hpp"
+
+AngularVelocityComponent::AngularVelocityComponent(const Vector3& angularVelocity) :
+    Component(Core::ComponentType::AngularVelocity),
+    angularVelocity(angularVelocity)
+{
+    ShareMessageHandlers(GetMessageHandlers());
+}
+
+AngularVelocityComponent::AngularVelocityComponent(const AngularVelocityComponent& other) :
+    Component(other),
+    angularVelocity(other.GetAngularVelocity())
+{
+}
+
+Vector3 AngularVelocityComponent::GetAngularVelocity() const
+{
+    if (storage != nullptr)
+    {
+        return Vector3(storage->wx[storageIndex], storage->wy[storageIndex], storage->wz[storageIndex]);
+    }
+    
+    return angularVelocity;
+}
+
+void AngularVelocityComponent::SetAngularVelocity(const Vector3& newAngularVelocity)
+{
+    if (storage != nullptr)
+    {
+        storage->wx[storageIndex] = newAngularVelocity.x;
+        storage->wy[storageIndex] = newAngularVelocity.y;
+        storage->wz[storageIndex] = newAngularVelocity.z;
+        return;
+    }
+    
+    angularVelocity = newAngularVelocity;
+}
+
+void AngularVelocityComponent::AttachStorage(Core::TransformStorage* newStorage, size_t index)
+{
+    storage = newStorage;
+    storageIndex = index;
+}
+
+void AngularVelocityComponent::DetachStorage()
+{
+    angularVelocity = GetAngularVelocity();
+    storage = nullptr;
+}
+
+const std::shared_ptr<Core::MessageHandlerTable>& AngularVelocityComponent::GetMessageHandlers()
+{
+    static std::shared_ptr<Core::MessageHandlerTable> s_handlers = []()
+    {
+        auto table = std::make_shared<Core::MessageHandlerTable>();
+        table->Register(MessageType::SetAngularVelocity, [](Core::Component* c, Core::BaseMessage* msg)
+        {
+            static_cast<AngularVelocityComponent*>(c)->MsgHandlerSetAngularVelocity(msg);
+        });
+        
+        return table;
+    }();
+    
+    return s_handlers;
+}
+
+void AngularVelocityComponent::MsgHandlerSetAngularVelocity(Core::BaseMessage* msg)
+{
+    SetAngularVelocity(static_cast<SetAngularVelocityMessage*>(msg)->angularVelocity);
+}
+
+void AngularVelocityComponent::Reflect(Core::ComponentRegistry& registry)
+{
+    registry.Register<AngularVelocityComponent>("AngularVelocity", Core::ComponentType::AngularVelocity)
+        .Property("angularVelocity", &AngularVelocityComponent::GetAngularVelocity, &AngularVelocityComponent::SetAngularVelocity);
+}
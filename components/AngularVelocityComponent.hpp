@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../core/Component.hpp"
+#include "../math/Vector3.hpp"
+
+namespace Core
+{
+    class ComponentRegistry;
+    class BaseMessage;
+    class TransformStorage;
+}
+
+// World space angular velocity in radians per second, as the rotation axis
+// scaled by the speed. Integrated into the object's rotation each step by
+// IntegrationSystem, the object needs a TransformComponent for it to do anything.
+class AngularVelocityComponent : public Core::Component
+{
+public:
+    explicit AngularVelocityComponent(const Vector3& angularVelocity);
+    AngularVelocityComponent(const AngularVelocityComponent& other);
+    
+    Vector3 GetAngularVelocity() const;
+    void SetAngularVelocity(const Vector3& angularVelocity);
+    
+    friend Core::TransformStorage;
+    
+    // Registers the type and its fields with the ComponentRegistry
+    static void Reflect(Core::ComponentRegistry& registry);
+    
+private:
+    static const std::shared_ptr<Core::MessageHandlerTable>& GetMessageHandlers();
+    
+    // Like TransformComponent, the data moves into the scene's TransformStorage
+    void AttachStorage(Core::TransformStorage* storage, size_t index);
+    void DetachStorage();
+    
+    void MsgHandlerSetAngularVelocity(Core::BaseMessage* msg);
+    
+private:
+    Vector3 angularVelocity;
+    
+    Core::TransformStorage* storage = nullptr;
+    size_t storageIndex = 0;
+};
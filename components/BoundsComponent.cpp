@@ -0,0 +1,17 @@
+#include "BoundsComponent.hpp"
+
+#include "../core/ComponentRegistry.hpp"
+
+BoundsComponent::BoundsComponent(const Vector3& center, const Vector3& halfExtents) :
+    Component(Core::ComponentType::Bounds),
+    center(center),
+    halfExtents(halfExtents)
+{
+}
+
+void BoundsComponent::Reflect(Core::ComponentRegistry& registry)
+{
+    registry.Register<BoundsComponent>("Bounds", Core::ComponentType::Bounds)
+        .Field("center", &BoundsComponent::center)
+        .Field("halfExtents", &BoundsComponent::halfExtents);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../core/Component.hpp"
+#include "../math/Vector3.hpp"
+
+namespace Core
+{
+    class ComponentRegistry;
+}
+
+// Axis-aligned box in the object's local space, given as a center offset
+// from the object's position and half the size along each axis. Used by
+// BroadPhase, which turns it into a world space AABB each step.
+class BoundsComponent : public Core::Component
+{
+public:
+    BoundsComponent(const Vector3& center, const Vector3& halfExtents);
+    BoundsComponent(const BoundsComponent& other) = default;
+    
+    const Vector3& GetCenter() const { return center; }
+    const Vector3& GetHalfExtents() const { return halfExtents; }
+    
+    void SetCenter(const Vector3& newCenter) { center = newCenter; }
+    void SetHalfExtents(const Vector3& newHalfExtents) { halfExtents = newHalfExtents; }
+    
+    // Registers the type and its fields with the ComponentRegistry
+    static void Reflect(Core::ComponentRegistry& registry);
+    
+private:
+    Vector3 center;
+    Vector3 halfExtents;
+};
@@ -1,33 +1,137 @@
 #include "TransformComponent.hpp"
 
 #include "../core/BaseMessage.hpp"
+#include "../core/ComponentRegistry.hpp"
 #include "../core/Object.hpp"
+#include "../core/TransformStorage.hpp"
 #include "../messages/SetPositionMessage.hpp"
 #include "../messages/GetPositionMessage.hpp"
+#include "../messages/SetRotationMessage.hpp"
 
 TransformComponent::TransformComponent(const Vector3& position, const Quaternion& rotation) :
     Component(Core::ComponentType::Transform),
     position(position),
     rotation(rotation)
 {
-    // TODO: Maybe a macro for message registration?
+    ShareMessageHandlers(GetMessageHandlers());
+}
+
+TransformComponent::TransformComponent(const TransformComponent& other) :
+    Component(other),
+    position(other.GetPosition()),
+    rotation(other.GetRotation())
+{
+}
+
+Vector3 TransformComponent::GetPosition() const
+{
+    if (storage != nullptr)
+    {
+        return storage->transforms.GetPosition(storageIndex);
+    }
+    
+    return position;
+}
+
+Quaternion TransformComponent::GetRotation() const
+{
+    if (storage != nullptr)
     {
-        auto callback = std::bind(&TransformComponent::MsgHandlerSetPosition, this, std::placeholders::_1);
-        RegisterMessage(MessageType::SetPosition, callback);
+        return storage->transforms.GetRotation(storageIndex);
     }
     
+    return rotation;
+}
+
+void TransformComponent::SetPosition(const Vector3& newPosition)
+{
+    if (storage != nullptr)
     {
-        auto callback = std::bind(&TransformComponent::MsgHandlerGetPosition, this, std::placeholders::_1);
-        RegisterMessage(MessageType::GetPosition, callback);
+        storage->transforms.px[storageIndex] = newPosition.x;
+        storage->transforms.py[storageIndex] = newPosition.y;
+        storage->transforms.pz[storageIndex] = newPosition.z;
+        storage->MarkWritten(storageIndex);
+        return;
     }
+    
+    position = newPosition;
+}
+
+void TransformComponent::SetRotation(const Quaternion& newRotation)
+{
+    if (storage != nullptr)
+    {
+        storage->transforms.rw[storageIndex] = newRotation.w;
+        storage->transforms.rx[storageIndex] = newRotation.x;
+        storage->transforms.ry[storageIndex] = newRotation.y;
+        storage->transforms.rz[storageIndex] = newRotation.z;
+        storage->MarkWritten(storageIndex);
+        return;
+    }
+    
+    rotation = newRotation;
+}
+
+void TransformComponent::AttachStorage(Core::TransformStorage* newStorage, size_t index)
+{
+    storage = newStorage;
+    storageIndex = index;
+}
+
+void TransformComponent::DetachStorage()
+{
+    position = GetPosition();
+    rotation = GetRotation();
+    storage = nullptr;
+}
+
+// Built once and shared by every TransformComponent
+const std::shared_ptr<Core::MessageHandlerTable>& TransformComponent::GetMessageHandlers()
+{
+    static std::shared_ptr<Core::MessageHandlerTable> s_handlers = []()
+    {
+        auto table = std::make_shared<Core::MessageHandlerTable>();
+        
+        // TODO: Maybe a macro for message registration?
+        table->Register(MessageType::SetPosition, [](Core::Component* c, Core::BaseMessage* msg)
+        {
+            static_cast<TransformComponent*>(c)->MsgHandlerSetPosition(msg);
+        });
+        
+        table->Register(MessageType::GetPosition, [](Core::Component* c, Core::BaseMessage* msg)
+        {
+            static_cast<TransformComponent*>(c)->MsgHandlerGetPosition(msg);
+        });
+        
+        table->Register(MessageType::SetRotation, [](Core::Component* c, Core::BaseMessage* msg)
+        {
+            static_cast<TransformComponent*>(c)->MsgHandlerSetRotation(msg);
+        });
+        
+        return table;
+    }();
+    
+    return s_handlers;
 }
 
 void TransformComponent::MsgHandlerSetPosition(Core::BaseMessage* msg)
 {
-    position = static_cast<SetPositionMessage*>(msg)->position;
+    SetPosition(static_cast<SetPositionMessage*>(msg)->position);
 }
 
 void TransformComponent::MsgHandlerGetPosition(Core::BaseMessage* msg)
 {
-    static_cast<GetPositionMessage*>(msg)->position = position;
+    static_cast<GetPositionMessage*>(msg)->position = GetPosition();
+}
+
+void TransformComponent::MsgHandlerSetRotation(Core::BaseMessage* msg)
+{
+    SetRotation(static_cast<SetRotationMessage*>(msg)->rotation);
+}
+
+void TransformComponent::Reflect(Core::ComponentRegistry& registry)
+{
+    registry.Register<TransformComponent>("Transform", Core::ComponentType::Transform)
+        .Property("position", &TransformComponent::GetPosition, &TransformComponent::SetPosition)
+        .Property("rotation", &TransformComponent::GetRotation, &TransformComponent::SetRotation);
 }
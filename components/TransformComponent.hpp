@@ -6,8 +6,10 @@
 
 namespace Core
 {
+    class ComponentRegistry;
     class Object;
     class BaseMessage;
+    class TransformStorage;
 }
 
 class TransformComponent : public Core::Component
@@ -15,13 +17,40 @@ class TransformComponent : public Core::Component
 public:
     TransformComponent(const Vector3& position, const Quaternion& rotation);
     
+    // Copies share the handler table, which is what lets a Prefab stamp out
+    // instances from a default without re-registering handlers. A copy gets
+    // the current values but isn't attached to any scene's storage.
+    TransformComponent(const TransformComponent& other);
+    
+    Vector3 GetPosition() const;
+    Quaternion GetRotation() const;
+    void SetPosition(const Vector3& position);
+    void SetRotation(const Quaternion& rotation);
+    
+    bool IsInStorage(const Core::TransformStorage& owner) const { return storage == &owner; }
+    size_t GetStorageIndex() const { return storageIndex; }
+    
+    // Registers the type and its fields with the ComponentRegistry
+    static void Reflect(Core::ComponentRegistry& registry);
+    
+    friend Core::TransformStorage;
+    
 private:
-    TransformComponent(const TransformComponent&);  // Prevent copying
+    static const std::shared_ptr<Core::MessageHandlerTable>& GetMessageHandlers();
+    
+    // Once the component is in a scene its data lives in the scene's
+    // TransformStorage, the members below are only used before that.
+    void AttachStorage(Core::TransformStorage* storage, size_t index);
+    void DetachStorage();
     
     void MsgHandlerSetPosition(Core::BaseMessage* msg);
     void MsgHandlerGetPosition(Core::BaseMessage* msg);
+    void MsgHandlerSetRotation(Core::BaseMessage* msg);
     
 private:
     Vector3 position;
     Quaternion rotation;
+    
+    Core::TransformStorage* storage = nullptr;
+    size_t storageIndex = 0;
 };
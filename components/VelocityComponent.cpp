@@ -0,0 +1,81 @@
+#include "VelocityComponent.hpp"
+
+#include "../core/BaseMessage.hpp"
+#include "../core/ComponentRegistry.hpp"
+#include "../core/TransformStorage.hpp"
+#include "../messages/SetVelocityMessage.hpp"
+
+VelocityComponent::VelocityComponent(const Vector3& velocity) :
+    Component(Core::ComponentType::Velocity),
+    velocity(velocity)
+{
+    ShareMessageHandlers(GetMessageHandlers());
+}
+
+VelocityComponent::VelocityComponent(const VelocityComponent& other) :
+    Component(other),
+    velocity(other.GetVelocity())
+{
+}
+
+Vector3 VelocityComponent::GetVelocity() const
+{
+    if (storage != nullptr)
+    {
+        return Vector3(storage->vx[storageIndex], storage->vy[storageIndex], storage->vz[storageIndex]);
+    }
+    
+    return velocity;
+}
+
+void VelocityComponent::SetVelocity(const Vector3& newVelocity)
+{
+    if (storage != nullptr)
+    {
+        storage->vx[storageIndex] = newVelocity.x;
+        storage->vy[storageIndex] = newVelocity.y;
+        storage->vz[storageIndex] = newVelocity.z;
+        return;
+    }
+    
+    velocity = newVelocity;
+}
+
+void VelocityComponent::AttachStorage(Core::TransformStorage* newStorage, size_t index)
+{
+    storage = newStorage;
+    storageIndex = index;
+}
+
+void VelocityComponent::DetachStorage()
+{
+    velocity = GetVelocity();
+    storage = nullptr;
+}
+
+const std::shared_ptr<Core::MessageHandlerTable>& VelocityComponent::GetMessageHandlers()
+{
+    static std::shared_ptr<Core::MessageHandlerTable> s_handlers = []()
+    {
+        auto table = std::make_shared<Core::MessageHandlerTable>();
+        table->Register(MessageType::SetVelocity, [](Core::Component* c, Core::BaseMessage* msg)
+        {
+            static_cast<VelocityComponent*>(c)->MsgHandlerSetVelocity(msg);
+        });
+        
+        return table;
+    }();
+    
+    return s_handlers;
+}
+
+void VelocityComponent::MsgHandlerSetVelocity(Core::BaseMessage* msg)
+{
+    SetVelocity(static_cast<SetVelocityMessage*>(msg)->velocity);
+}
+
+void VelocityComponent::Reflect(Core::ComponentRegistry& registry)
+{
+    registry.Register<VelocityComponent>("Velocity", Core::ComponentType::Velocity)
+        .Property("velocity", &VelocityComponent::GetVelocity, &VelocityComponent::SetVelocity);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../core/Component.hpp"
+#include "../math/Vector3.hpp"
+
+namespace Core
+{
+    class ComponentRegistry;
+    class BaseMessage;
+    class TransformStorage;
+}
+
+// Linear velocity in units per second. Integrated into the object's position
+// each step by IntegrationSystem, the object needs a TransformComponent for it
+// to do anything.
+class VelocityComponent : public Core::Component
+{
+public:
+    explicit VelocityComponent(const Vector3& velocity);
+    VelocityComponent(const VelocityComponent& other);
+    
+    Vector3 GetVelocity() const;
+    void SetVelocity(const Vector3& velocity);
+    
+    friend Core::TransformStorage;
+    
+    // Registers the type and its fields with the ComponentRegistry
+    static void Reflect(Core::ComponentRegistry& registry);
+    
+private:
+    static const std::shared_ptr<Core::MessageHandlerTable>& GetMessageHandlers();
+    
+    // Like TransformComponent, the data moves into the scene's TransformStorage
+    void AttachStorage(Core::TransformStorage* storage, size_t index);
+    void DetachStorage();
+    
+    void MsgHandlerSetVelocity(Core::BaseMessage* msg);
+    
+private:
+    Vector3 velocity;
+    
+    Core::TransformStorage* storage = nullptr;
+    size_t storageIndex = 0;
+};
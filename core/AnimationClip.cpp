@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <cmath>
+#include "AnimationClip.hpp"
+#include "../math/Trig.hpp"
+
+namespace Core
+{
+// Smallest-three components lie in [-1/sqrt(2), 1/sqrt(2)]. An even number
+// of steps puts one exactly on 0, so identity and axis rotations come back
+// exact.
+static const float RotationRange = 0.70710678f;
+static const float RotationSteps = 32766.0f;
+
+// Greedily keeps as few keys as it can such that interpolating between kept
+// keys lands within tolerance of every dropped sample. 'fits(first, last, i)'
+// checks sample i against the interpolation from first to last. Each segment
+// is found by doubling its length and then bisecting, so a clip costs about
+// n log n checks rather than n squared.
+template <typename Fits>
+static std::vector<uint32_t> ReduceKeys(size_t sampleCount, Fits fits)
+{
+    std::vector<uint32_t> kept;
+    if (sampleCount == 0)
+    {
+        return kept;
+    }
+    
+    auto segmentFits = [&fits](uint32_t first, uint32_t last)
+    {
+        for (uint32_t i = first + 1; i < last; ++i)
+        {
+            if (!fits(first, last, i))
+            {
+                return false;
+            }
+        }
+        
+        return true;
+    };
+    
+    const uint32_t lastSample = static_cast<uint32_t>(sampleCount - 1);
+    uint32_t first = 0;
+    kept.push_back(first);
+    
+    while (first < lastSample)
+    {
+        // Neighbouring keys always fit. Double until a segment doesn't...
+        uint32_t good = first + 1;
+        uint32_t bad = 0;
+        while (good < lastSample)
+        {
+            uint32_t candidate = std::min(first + 2 * (good - first), lastSample);
+            if (!segmentFits(first, candidate))
+            {
+                bad = candidate;
+                break;
+            }
+            
+            good = candidate;
+        }
+        
+        // ...then narrow down between the last one that did and that
+        while (bad > good + 1)
+        {
+            uint32_t middle = good + (bad - good) / 2;
+            if (segmentFits(first, middle))
+            {
+                good = middle;
+            }
+            else
+            {
+                bad = middle;
+            }
+        }
+        
+        kept.push_back(good);
+        first = good;
+    }
+    
+    return kept;
+}
+
+AnimationClip::AnimationClip(float sampleRate) :
+    sampleRate(sampleRate)
+{
+}
+
+uint32_t AnimationClip::AddTrack(const std::vector<Vector3>& positions, const std::vector<Quaternion>& rotations,
+                                 float positionTolerance, float rotationTolerance)
+{
+    if (positions.empty() || rotations.empty())
+    {
+        throw "Animation tracks need at least one key per channel";
+    }
+    
+    if (positions.size() > 65536 || rotations.size() > 65536)
+    {
+        throw "Animation tracks are limited to 65536 frames";
+    }
+    
+    Track track;
+    
+    // Positions
+    Vector3 minimum = positions[0];
+    Vector3 maximum = positions[0];
+    for (const Vector3& position : positions)
+    {
+        minimum = Vector3(std::min(minimum.x, position.x), std::min(minimum.y, position.y), std::min(minimum.z, position.z));
+        maximum = Vector3(std::max(maximum.x, position.x), std::max(maximum.y, position.y), std::max(maximum.z, position.z));
+    }
+    
+    track.positionMin[0] = minimum.x;
+    track.positionMin[1] = minimum.y;
+    track.positionMin[2] = minimum.z;
+    track.positionScale[0] = (maximum.x - minimum.x) / 65535.0f;
+    track.positionScale[1] = (maximum.y - minimum.y) / 65535.0f;
+    track.positionScale[2] = (maximum.z - minimum.z) / 65535.0f;
+    
+    const float positionToleranceSqr = positionTolerance * positionTolerance;
+    std::vector<uint32_t> kept = ReduceKeys(positions.size(), [&](uint32_t first, uint32_t last, uint32_t i)
+    {
+        float t = (float)(i - first) / (float)(last - first);
+        return (Vector3::Lerp(positions[first], positions[last], t) - positions[i]).LengthSqr() <= positionToleranceSqr;
+    });
+    
+    track.positionBegin = static_cast<uint32_t>(positionFrames.size());
+    track.positionCount = static_cast<uint32_t>(kept.size());
+    for (uint32_t frame : kept)
+    {
+        QuantizedPosition key;
+        uint16_t* axes[3] = { &key.x, &key.y, &key.z };
+        float values[3] = { positions[frame].x, positions[frame].y, positions[frame].z };
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float steps = track.positionScale[axis] > 0.0f ? (values[axis] - track.positionMin[axis]) / track.positionScale[axis] : 0.0f;
+            *axes[axis] = static_cast<uint16_t>(std::clamp(lroundf(steps), 0L, 65535L));
+        }
+        
+        positionFrames.push_back(static_cast<uint16_t>(frame));
+        positionKeys.push_back(key);
+    }
+    
+    // Rotations. Half the angle between two unit quaternions is acos(|dot|).
+    const float minimumDot = Trig::Cos(rotationTolerance * 0.5f);
+    kept = ReduceKeys(rotations.size(), [&](uint32_t first, uint32_t last, uint32_t i)
+    {
+        float t = (float)(i - first) / (float)(last - first);
+        Quaternion blended = Quaternion::Nlerp(rotations[first], rotations[last], t);
+        Quaternion sample = rotations[i].GetUnitized();
+        float dot = blended.w * sample.w + blended.x * sample.x + blended.y * sample.y + blended.z * sample.z;
+        return fabsf(dot) >= minimumDot;
+    });
+    
+    track.rotationBegin = static_cast<uint32_t>(rotationFrames.size());
+    track.rotationCount = static_cast<uint32_t>(kept.size());
+    for (uint32_t frame : kept)
+    {
+        rotationFrames.push_back(static_cast<uint16_t>(frame));
+        rotationKeys.push_back(QuantizeRotation(rotations[frame]));
+    }
+    
+    size_t frameCount = std::max(positions.size(), rotations.size());
+    duration = std::max(duration, (float)(frameCount - 1) / sampleRate);
+    
+    tracks.push_back(track);
+    return static_cast<uint32_t>(tracks.size() - 1);
+}
+
+void AnimationClip::Sample(uint32_t trackIndex, float seconds, AnimationCursor& cursor, Vector3& outPosition, Quaternion& outRotation) const
+{
+    const Track& track = tracks[trackIndex];
+    const float frame = seconds * sampleRate;
+    
+    const uint16_t* frames = &positionFrames[track.positionBegin];
+    const QuantizedPosition* positions = &positionKeys[track.positionBegin];
+    uint32_t key = FindKey(frames, track.positionCount, frame, cursor.positionKey);
+    cursor.positionKey = key;
+    
+    if (key + 1 < track.positionCount)
+    {
+        float t = std::clamp((frame - frames[key]) / (float)(frames[key + 1] - frames[key]), 0.0f, 1.0f);
+        outPosition = Vector3::Lerp(DequantizePosition(track, positions[key]), DequantizePosition(track, positions[key + 1]), t);
+    }
+    else
+    {
+        outPosition = DequantizePosition(track, positions[key]);
+    }
+    
+    frames = &rotationFrames[track.rotationBegin];
+    const QuantizedRotation* rotations = &rotationKeys[track.rotationBegin];
+    key = FindKey(frames, track.rotationCount, frame, cursor.rotationKey);
+    cursor.rotationKey = key;
+    
+    if (key + 1 < track.rotationCount)
+    {
+        float t = std::clamp((frame - frames[key]) / (float)(frames[key + 1] - frames[key]), 0.0f, 1.0f);
+        outRotation = Quaternion::Nlerp(DequantizeRotation(rotations[key]), DequantizeRotation(rotations[key + 1]), t);
+    }
+    else
+    {
+        outRotation = DequantizeRotation(rotations[key]);
+    }
+}
+
+size_t AnimationClip::GetMemoryUsage() const
+{
+    return sizeof(AnimationClip)
+        + tracks.capacity() * sizeof(Track)
+        + positionFrames.capacity() * sizeof(uint16_t)
+        + positionKeys.capacity() * sizeof(QuantizedPosition)
+        + rotationFrames.capacity() * sizeof(uint16_t)
+        + rotationKeys.capacity() * sizeof(QuantizedRotation);
+}
+
+uint32_t AnimationClip::FindKey(const uint16_t* frames, uint32_t count, float frame, uint32_t cursor)
+{
+    // Playing forwards the answer is almost always the cursor's key or the
+    // one after it
+    if (cursor < count && frames[cursor] <= frame)
+    {
+        if (cursor + 1 >= count || frame < frames[cursor + 1])
+        {
+            return cursor;
+        }
+        
+        if (cursor + 2 >= count || frame < frames[cursor + 2])
+        {
+            return cursor + 1;
+        }
+    }
+    
+    // Jumped or looped, search for it
+    const uint16_t* after = std::upper_bound(frames, frames + count, frame, [](float value, uint16_t key)
+    {
+        return value < (float)key;
+    });
+    
+    return after == frames ? 0 : static_cast<uint32_t>(after - frames - 1);
+}
+
+AnimationClip::QuantizedRotation AnimationClip::QuantizeRotation(const Quaternion& rotation)
+{
+    Quaternion unit = rotation.GetUnitized();
+    float values[4] = { unit.w, unit.x, unit.y, unit.z };
+    
+    int largest = 0;
+    for (int i = 1; i < 4; ++i)
+    {
+        if (fabsf(values[i]) > fabsf(values[largest]))
+        {
+            largest = i;
+        }
+    }
+    
+    // q and -q are the same rotation, so flip to make the dropped one positive
+    float sign = values[largest] < 0.0f ? -1.0f : 1.0f;
+    
+    uint16_t packed[3];
+    for (int i = 0, j = 0; i < 4; ++i)
+    {
+        if (i != largest)
+        {
+            float normalized = (values[i] * sign / RotationRange) * 0.5f + 0.5f;
+            packed[j++] = static_cast<uint16_t>(std::clamp(lroundf(normalized * RotationSteps), 0L, (long)RotationSteps));
+        }
+    }
+    
+    return QuantizedRotation{ static_cast<uint16_t>(packed[0] | ((largest & 1) << 15)),
+                              static_cast<uint16_t>(packed[1] | ((largest >> 1) << 15)),
+                              packed[2] };
+}
+
+Quaternion AnimationClip::DequantizeRotation(const QuantizedRotation& rotation)
+{
+    int largest = (rotation.a >> 15) | ((rotation.b >> 15) << 1);
+    uint16_t packed[3] = { static_cast<uint16_t>(rotation.a & 0x7fff), static_cast<uint16_t>(rotation.b & 0x7fff), rotation.c };
+    
+    float values[4];
+    float sumSqr = 0.0f;
+    for (int i = 0, j = 0; i < 4; ++i)
+    {
+        if (i != largest)
+        {
+            values[i] = ((float)packed[j++] / RotationSteps * 2.0f - 1.0f) * RotationRange;
+            sumSqr += values[i] * values[i];
+        }
+    }
+    
+    values[largest] = sqrtf(std::max(0.0f, 1.0f - sumSqr));
+    return Quaternion(values[0], values[1], values[2], values[3]);
+}
+
+Vector3 AnimationClip::DequantizePosition(const Track& track, const QuantizedPosition& position) const
+{
+    return Vector3(track.positionMin[0] + position.x * track.positionScale[0],
+                   track.positionMin[1] + position.y * track.positionScale[1],
+                   track.positionMin[2] + position.z * track.positionScale[2]);
+}
+}
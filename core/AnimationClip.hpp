@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../math/Quaternion.hpp"
+#include "../math/Vector3.hpp"
+
+namespace Core
+{
+// Per-player position in each channel of a track, so sequential playback
+// finds its keys without searching
+struct AnimationCursor
+{
+    uint32_t positionKey = 0;
+    uint32_t rotationKey = 0;
+};
+
+// A set of transform tracks sampled at a fixed rate, stored compressed:
+//  - keys that linear interpolation of their neighbours reproduces within a
+//    tolerance are dropped, so each channel keeps only the keys it needs
+//  - key times are 16 bit frame numbers
+//  - positions are 16 bits per axis across the track's range
+//  - rotations are 15 bits per each of the three smallest components, the
+//    largest is rebuilt from unit length and its index takes the spare bits
+// A key is 6 bytes plus 2 for its time, against 12 or 16 raw.
+class AnimationClip
+{
+public:
+    explicit AnimationClip(float sampleRate = 30.0f);
+    
+    // Compresses one uniformly sampled track and returns its index. Tolerances
+    // are in world units for positions and radians for rotations.
+    uint32_t AddTrack(const std::vector<Vector3>& positions, const std::vector<Quaternion>& rotations,
+                      float positionTolerance = 0.001f, float rotationTolerance = 0.001f);
+    
+    // Samples a track at 'seconds', clamped to the track's length. Keep the
+    // cursor between calls for sequential playback; a fresh one works anywhere.
+    void Sample(uint32_t track, float seconds, AnimationCursor& cursor, Vector3& outPosition, Quaternion& outRotation) const;
+    
+    size_t GetTrackCount() const { return tracks.size(); }
+    float GetSampleRate() const { return sampleRate; }
+    float GetDuration() const { return duration; }
+    
+    size_t GetKeyCount() const { return positionFrames.size() + rotationFrames.size(); }
+    size_t GetMemoryUsage() const;
+    
+private:
+    struct Track
+    {
+        uint32_t positionBegin, positionCount;
+        uint32_t rotationBegin, rotationCount;
+        float positionMin[3];
+        float positionScale[3];     // Range / 65535 per axis
+    };
+    
+    struct QuantizedPosition
+    {
+        uint16_t x, y, z;
+    };
+    
+    // The top bits of a and b hold which component was dropped
+    struct QuantizedRotation
+    {
+        uint16_t a, b, c;
+    };
+    
+    static QuantizedRotation QuantizeRotation(const Quaternion& rotation);
+    static Quaternion DequantizeRotation(const QuantizedRotation& rotation);
+    Vector3 DequantizePosition(const Track& track, const QuantizedPosition& position) const;
+    
+    // Index of the last key at or before 'frame', starting from 'cursor'
+    static uint32_t FindKey(const uint16_t* frames, uint32_t count, float frame, uint32_t cursor);
+    
+private:
+    float sampleRate;
+    float duration = 0.0f;
+    
+    std::vector<Track> tracks;
+    std::vector<uint16_t> positionFrames;
+    std::vector<QuantizedPosition> positionKeys;
+    std::vector<uint16_t> rotationFrames;
+    std::vector<QuantizedRotation> rotationKeys;
+};
+}
@@ -2,9 +2,10 @@
 
 namespace Core
 {
-    BaseMessage::BaseMessage(int targetObjectID, MessageType messageType) :
+    BaseMessage::BaseMessage(int targetObjectID, MessageType messageType, bool lastWriterWins) :
         targetObjectID(targetObjectID),
-        messageType(messageType)
+        messageType(messageType),
+        lastWriterWins(lastWriterWins)
     {
     }
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include "MemoryTracker.hpp"
+
 enum class MessageType
 {
     AddComponent = 0,
@@ -7,6 +10,10 @@ enum class MessageType
     SetPosition,
     GetRotation,
     SetRotation,
+    SetVelocity,
+    SetAngularVelocity,
+    
+    Count   // Must remain last, used to size per-type tables
 };
 
 namespace Core
@@ -14,14 +21,35 @@ namespace Core
     class BaseMessage
     {
     public:
+        virtual ~BaseMessage() {}
+        
+        // Heap messages (mostly queued clones) are counted as MemoryCategory::Messages
+        static void* operator new(size_t size) { return MemoryTracker::Allocate(MemoryCategory::Messages, size); }
+        static void operator delete(void* memory, size_t size) { MemoryTracker::Free(MemoryCategory::Messages, memory, size); }
+        
         int GetTargetObjectID() const { return targetObjectID; }
         MessageType GetType() const { return messageType; }
         
+        // A last-writer-wins message only cares about the most recent send to
+        // an object, so earlier sends of the same type can be dropped when
+        // messages are queued (see MessageQueue).
+        bool IsLastWriterWins() const { return lastWriterWins; }
+        
+        // Queued messages need to outlive the caller's stack copy. Message types
+        // that can be queued must override this.
+        virtual BaseMessage* Clone() const { return nullptr; }
+        
+        // Overwrites this message with another of the same type, so a queued
+        // message can be replaced without another allocation. Types that
+        // implement Clone() should implement this too.
+        virtual void CopyFrom(const BaseMessage& other) {}
+        
     protected:
-        BaseMessage(int targetObjectID, MessageType messageType);
+        BaseMessage(int targetObjectID, MessageType messageType, bool lastWriterWins = false);
         
     private:
         int targetObjectID;
         MessageType messageType;
+        bool lastWriterWins;
     };
 }
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+#include "MemoryTracker.hpp"
+
+namespace Core
+{
+// Fixed-size run of objects or components constructed in one allocation.
+// Users hold aliasing shared_ptrs into the block, so the block goes away once
+// the last one of those is released. Releasing one of those pointers doesn't
+// destroy its item, so an owner that knows an item is finished with calls
+// Destroy() to run its destructor early.
+template <typename T>
+class BlockStorage
+{
+public:
+    BlockStorage(size_t capacity, MemoryCategory category) :
+        items(static_cast<T*>(MemoryTracker::Allocate(category, capacity * sizeof(T), alignof(T)))),
+        count(0),
+        capacity(capacity),
+        category(category)
+    {
+    }
+    
+    ~BlockStorage()
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!IsDestroyed(i))
+            {
+                items[i].~T();
+            }
+        }
+        
+        if (destroyedBits != nullptr)
+        {
+            MemoryTracker::Free(category, destroyedBits, BitWordCount() * sizeof(uint64_t), alignof(uint64_t));
+        }
+        
+        MemoryTracker::Free(category, items, capacity * sizeof(T), alignof(T));
+    }
+    
+    template <typename... Args>
+    T* Emplace(Args&&... args)
+    {
+        T* item = ::new (items + count) T(std::forward<Args>(args)...);
+        ++count;
+        return item;
+    }
+    
+    // Runs the item's destructor now. The slot isn't reused, its memory goes
+    // with the rest of the block.
+    void Destroy(T* item)
+    {
+        size_t index = item - items;
+        if (destroyedBits == nullptr)
+        {
+            // Most blocks are never partly destroyed, so the bits are only
+            // allocated once one is
+            destroyedBits = static_cast<uint64_t*>(MemoryTracker::Allocate(category, BitWordCount() * sizeof(uint64_t), alignof(uint64_t)));
+            std::memset(destroyedBits, 0, BitWordCount() * sizeof(uint64_t));
+        }
+        
+        if (IsDestroyed(index))
+        {
+            throw "Block item destroyed twice.";
+        }
+        
+        destroyedBits[index / 64] |= uint64_t(1) << (index % 64);
+        item->~T();
+    }
+    
+private:
+    BlockStorage(const BlockStorage&);  // Prevent copying
+    
+    size_t BitWordCount() const { return (capacity + 63) / 64; }
+    bool IsDestroyed(size_t index) const { return destroyedBits != nullptr && (destroyedBits[index / 64] & (uint64_t(1) << (index % 64))) != 0; }
+    
+private:
+    T* items;
+    size_t count;
+    size_t capacity;
+    MemoryCategory category;
+    uint64_t* destroyedBits = nullptr;
+};
+}
@@ -7,38 +7,42 @@ Component::Component(ComponentType componentType) :
 {
 }
     
+Component::Component(const Component& other) :
+    componentType(other.componentType),
+    messageHandlers(other.messageHandlers)
+{
+}
+
 Component::~Component()
 {
-    if (messageHandlers != nullptr)
-    {
-        messageHandlers->clear();
-    }
 }
 
 bool Component::SendMessage(BaseMessage* msg)
 {
-    if (messageHandlers == nullptr)
+    const MessageHandlerTable* table = messageHandlers.Get();
+    if (table == nullptr)
     {
         return false;
     }
     
-    auto handler = messageHandlers->find(msg->GetType());
-    if (handler != messageHandlers->end())
+    const MessageHandler& handler = table->Find(msg->GetType());
+    if (handler)
     {
-        handler->second(msg);
+        handler(this, msg);
+        return true;
     }
     
     return false;
 }
 
-void Component::RegisterMessage(MessageType type, std::function<void(BaseMessage*)> handler)
+void Component::RegisterMessage(MessageType type, MessageHandler handler)
 {
-    if (messageHandlers == nullptr)
-    {
-        messageHandlers = new std::map<MessageType, std::function<void(BaseMessage*)>>();
-    }
-    
-    (*messageHandlers)[type] = handler;
+    messageHandlers.Write().Register(type, handler);
+}
+
+void Component::ShareMessageHandlers(std::shared_ptr<MessageHandlerTable> table)
+{
+    messageHandlers = CopyOnWrite<MessageHandlerTable>(std::move(table));
 }
 
 void Component::ProvideObject(std::shared_ptr<Object> object)
@@ -1,38 +1,86 @@
 #pragma once
 
-#include <map>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include "BaseMessage.hpp"
+#include "CopyOnWrite.hpp"
+#include "MemoryTracker.hpp"
 
 namespace Core
 {
     class Object;
     
-    enum class ComponentType
+    // Dense component type IDs. The built-in types are listed here, types
+    // added through ComponentRegistry take the IDs from BuiltInCount up.
+    enum class ComponentType : uint32_t
     {
-        Transform = 0
+        Transform = 0,
+        Velocity,
+        AngularVelocity,
+        Bounds,
+        BuiltInCount
+    };
+    
+    // Objects track which component types they have as a 64 bit mask
+    const uint32_t MaxComponentTypes = 64;
+    inline uint64_t ComponentBit(ComponentType type) { return uint64_t(1) << static_cast<uint32_t>(type); }
+    
+    class Component;
+    
+    // Handlers receive the component the message was sent to, so a single
+    // handler can serve every instance of a component type.
+    typedef std::function<void(Component*, BaseMessage*)> MessageHandler;
+    
+    // Handlers indexed directly by MessageType
+    struct MessageHandlerTable
+    {
+        void Register(MessageType type, MessageHandler handler) { handlers[static_cast<size_t>(type)] = handler; }
+        const MessageHandler& Find(MessageType type) const { return handlers[static_cast<size_t>(type)]; }
+        
+        MessageHandler handlers[static_cast<size_t>(MessageType::Count)];
     };
     
     class Component
     {
     public:
-        ~Component();
+        virtual ~Component();
+        
+        // Components created with new are counted as MemoryCategory::Components.
+        // Prefab batches are counted by their BlockStorage instead.
+        static void* operator new(size_t size) { return MemoryTracker::Allocate(MemoryCategory::Components, size); }
+        static void operator delete(void* memory, size_t size) { MemoryTracker::Free(MemoryCategory::Components, memory, size); }
         
         ComponentType GetComponentType() const { return componentType; }
         
         bool SendMessage(BaseMessage* msg);
-        void RegisterMessage(MessageType type, std::function<void(BaseMessage*)> handler);
+        
+        // Adds a handler to this instance only. If the handler table is shared
+        // with other instances it is copied first.
+        void RegisterMessage(MessageType type, MessageHandler handler);
+        
+        // The instance's handler table, which may be shared with other instances
+        const MessageHandlerTable* GetMessageHandlerTable() const { return messageHandlers.Get(); }
+        bool HasOwnMessageHandlers() const { return messageHandlers.Get() != nullptr && !messageHandlers.IsShared(); }
         
         friend Object;
         
     protected:
         Component(ComponentType componentType);
         
+        // Copies share the source's handler table but aren't attached to an object
+        Component(const Component& other);
+        
+        // Component types normally build one table of handlers and hand it to
+        // every instance, instead of each instance registering its own.
+        void ShareMessageHandlers(std::shared_ptr<MessageHandlerTable> table);
+        
         void ProvideObject(std::shared_ptr<Object> object);
         
     private:
         ComponentType componentType;
         std::shared_ptr<Object> object;
         
-        std::map<MessageType, std::function<void(BaseMessage*)>>* messageHandlers = nullptr;
+        CopyOnWrite<MessageHandlerTable> messageHandlers;
     };
 }
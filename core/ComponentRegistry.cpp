@@ -0,0 +1,103 @@
+#include "ComponentRegistry.hpp"
+
+#include "../components/AngularVelocityComponent.hpp"
+#include "../components/BoundsComponent.hpp"
+#include "../components/TransformComponent.hpp"
+#include "../components/VelocityComponent.hpp"
+
+namespace Core
+{
+const ComponentField* ComponentTypeInfo::FindField(const std::string& fieldName) const
+{
+    for (const ComponentField& field : fields)
+    {
+        if (field.name == fieldName)
+        {
+            return &field;
+        }
+    }
+    
+    return nullptr;
+}
+
+ComponentRegistry& ComponentRegistry::Get()
+{
+    static ComponentRegistry registry;
+    return registry;
+}
+
+ComponentRegistry::ComponentRegistry()
+{
+    TransformComponent::Reflect(*this);
+    VelocityComponent::Reflect(*this);
+    AngularVelocityComponent::Reflect(*this);
+    BoundsComponent::Reflect(*this);
+}
+
+ComponentTypeInfo& ComponentRegistry::Add(std::type_index cppType, std::unique_ptr<ComponentTypeInfo> info)
+{
+    size_t index = static_cast<size_t>(info->id);
+    
+    if (index >= MaxComponentTypes)
+    {
+        throw "Too many component types";
+    }
+    
+    if (typesByCppType.find(cppType) != typesByCppType.end())
+    {
+        throw "Component type already registered";
+    }
+    
+    if (typesByName.find(info->name) != typesByName.end())
+    {
+        throw "Component type name already registered";
+    }
+    
+    if (index < types.size() && types[index] != nullptr)
+    {
+        throw "Component type ID already registered";
+    }
+    
+    if (index >= types.size())
+    {
+        types.resize(index + 1);
+    }
+    
+    typesByCppType[cppType] = info->id;
+    typesByName[info->name] = info->id;
+    types[index] = std::move(info);
+    return *types[index];
+}
+
+const ComponentTypeInfo* ComponentRegistry::Find(ComponentType id) const
+{
+    size_t index = static_cast<size_t>(id);
+    return index < types.size() ? types[index].get() : nullptr;
+}
+
+const ComponentTypeInfo* ComponentRegistry::Find(const std::string& name) const
+{
+    auto it = typesByName.find(name);
+    return it != typesByName.end() ? Find(it->second) : nullptr;
+}
+
+void ComponentRegistry::Print(std::ostream& out, const Component& component) const
+{
+    const ComponentTypeInfo* info = Find(component.GetComponentType());
+    if (info == nullptr)
+    {
+        out << "Unregistered component " << static_cast<size_t>(component.GetComponentType());
+        return;
+    }
+    
+    out << info->name << " {";
+    for (size_t i = 0; i < info->fields.size(); ++i)
+    {
+        const ComponentField& field = info->fields[i];
+        out << (i == 0 ? " " : ", ") << field.name << ": ";
+        std::visit([&out](const auto& value) { out << value; }, field.get(component));
+    }
+    
+    out << " }";
+}
+}
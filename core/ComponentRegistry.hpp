@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include "Component.hpp"
+#include "../math/Quaternion.hpp"
+#include "../math/Vector3.hpp"
+
+namespace Core
+{
+// Values a reflected field can hold. FieldType matches the variant index.
+typedef std::variant<bool, int, float, Vector3, Quaternion> FieldValue;
+
+enum class FieldType
+{
+    Bool = 0,
+    Int,
+    Float,
+    Vector3,
+    Quaternion,
+};
+
+struct ComponentField
+{
+    std::string name;
+    FieldType type;
+    
+    // Byte offset for plain data members, NotAMember for fields reached
+    // through accessors (such as anything kept in TransformStorage)
+    size_t offset;
+    static const size_t NotAMember = SIZE_MAX;
+    
+    std::function<FieldValue(const Component&)> get;
+    std::function<void(Component&, const FieldValue&)> set;
+};
+
+struct ComponentTypeInfo
+{
+    std::string name;
+    ComponentType id;
+    size_t size;
+    size_t alignment;
+    bool triviallyCopyable;
+    std::vector<ComponentField> fields;
+    
+    // Copy-constructs a new instance, the same way a Prefab instantiates
+    std::function<std::shared_ptr<Component>(const Component&)> clone;
+    
+    // Returns nullptr if there's no field by this name
+    const ComponentField* FindField(const std::string& fieldName) const;
+};
+
+// Adds fields to a type as it's registered:
+//
+//     registry.Register<BoundsComponent>("Bounds", ComponentType::Bounds)
+//         .Field("center", &BoundsComponent::center)
+//         .Property("halfExtents", &BoundsComponent::GetHalfExtents, &BoundsComponent::SetHalfExtents);
+template <typename T>
+class ComponentTypeBuilder
+{
+public:
+    explicit ComponentTypeBuilder(ComponentTypeInfo& info) : info(info) {}
+    
+    // A data member, read and written in place
+    template <typename Value>
+    ComponentTypeBuilder& Field(const std::string& name, Value T::* member)
+    {
+        // Offset of the member within an (unconstructed) T
+        alignas(T) unsigned char buffer[sizeof(T)];
+        const T* instance = reinterpret_cast<const T*>(buffer);
+        size_t offset = reinterpret_cast<const unsigned char*>(&(instance->*member)) - buffer;
+        
+        info.fields.push_back(ComponentField{ name, TypeOf<Value>(), offset,
+            [member](const Component& component) { return FieldValue(static_cast<const T&>(component).*member); },
+            [member](Component& component, const FieldValue& value) { static_cast<T&>(component).*member = std::get<Value>(value); } });
+        return *this;
+    }
+    
+    // A value behind a getter and setter
+    template <typename Getter, typename Setter>
+    ComponentTypeBuilder& Property(const std::string& name, Getter getter, Setter setter)
+    {
+        typedef std::decay_t<std::invoke_result_t<Getter, const T&>> Value;
+        
+        info.fields.push_back(ComponentField{ name, TypeOf<Value>(), ComponentField::NotAMember,
+            [getter](const Component& component) { return FieldValue(std::invoke(getter, static_cast<const T&>(component))); },
+            [setter](Component& component, const FieldValue& value) { std::invoke(setter, static_cast<T&>(component), std::get<Value>(value)); } });
+        return *this;
+    }
+    
+private:
+    template <typename Value>
+    static FieldType TypeOf()
+    {
+        return static_cast<FieldType>(FieldValue(Value()).index());
+    }
+    
+private:
+    ComponentTypeInfo& info;
+};
+
+// Every component type with its dense ID, layout and reflected fields, so
+// tooling, serialization and storage can work on components generically.
+// The built-in components register at their ComponentType values when the
+// registry is first used; anything else registered gets the next free ID,
+// which it passes to the Component constructor:
+//
+//     HealthComponent() : Component(ComponentRegistry::Get().GetTypeID<HealthComponent>()) {}
+//
+// Register types at startup, before other threads look anything up.
+class ComponentRegistry
+{
+public:
+    static ComponentRegistry& Get();
+    
+    template <typename T>
+    ComponentTypeBuilder<T> Register(const std::string& name)
+    {
+        return Register<T>(name, static_cast<ComponentType>(types.size()));
+    }
+    
+    template <typename T>
+    ComponentTypeBuilder<T> Register(const std::string& name, ComponentType id)
+    {
+        static_assert(std::is_base_of_v<Component, T>, "Only components can be registered");
+        
+        auto info = std::make_unique<ComponentTypeInfo>();
+        info->name = name;
+        info->id = id;
+        info->size = sizeof(T);
+        info->alignment = alignof(T);
+        info->triviallyCopyable = std::is_trivially_copyable_v<T>;
+        info->clone = [](const Component& component) -> std::shared_ptr<Component>
+        {
+            return std::allocate_shared<T>(TrackingAllocator<T, MemoryCategory::Components>(), static_cast<const T&>(component));
+        };
+        
+        ComponentTypeInfo& added = Add(std::type_index(typeid(T)), std::move(info));
+        return ComponentTypeBuilder<T>(added);
+    }
+    
+    // Throws if T hasn't been registered
+    template <typename T>
+    ComponentType GetTypeID() const
+    {
+        auto it = typesByCppType.find(std::type_index(typeid(T)));
+        if (it == typesByCppType.end())
+        {
+            throw "Component type not registered";
+        }
+        
+        return it->second;
+    }
+    
+    // Both return nullptr for unknown types
+    const ComponentTypeInfo* Find(ComponentType id) const;
+    const ComponentTypeInfo* Find(const std::string& name) const;
+    
+    size_t GetTypeCount() const { return types.size(); }
+    
+    // Writes "Name { field: value, ... }"
+    void Print(std::ostream& out, const Component& component) const;
+    
+private:
+    ComponentRegistry();
+    
+    // Prevent copying
+    ComponentRegistry(const ComponentRegistry& other);
+    
+    ComponentTypeInfo& Add(std::type_index cppType, std::unique_ptr<ComponentTypeInfo> info);
+    
+private:
+    // Indexed by ID
+    std::vector<std::unique_ptr<ComponentTypeInfo>> types;
+    std::unordered_map<std::string, ComponentType> typesByName;
+    std::unordered_map<std::type_index, ComponentType> typesByCppType;
+};
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+
+namespace Core
+{
+// Holds data that is usually shared between many owners (e.g. every instance
+// of a component type) and only gets its own copy the first time it is written.
+template <typename T>
+class CopyOnWrite
+{
+public:
+    CopyOnWrite() {}
+    explicit CopyOnWrite(std::shared_ptr<T> shared) : data(std::move(shared)) {}
+    
+    const T* Get() const { return data.get(); }
+    bool IsShared() const { return data.use_count() > 1; }
+    
+    // Returns a reference that only this owner can see, copying the shared
+    // data first if anyone else still refers to it.
+    T& Write()
+    {
+        if (data == nullptr)
+        {
+            data = std::make_shared<T>();
+        }
+        else if (IsShared())
+        {
+            data = std::make_shared<T>(*data);
+        }
+        
+        return *data;
+    }
+    
+private:
+    std::shared_ptr<T> data;
+};
+}
@@ -0,0 +1,67 @@
+#include "EventBus.hpp"
+#include "SceneManager.hpp"
+
+namespace Core
+{
+EventFilter EventFilter::Tags(uint32_t requiredTags)
+{
+    EventFilter filter;
+    filter.requiredTags = requiredTags;
+    return filter;
+}
+
+EventFilter EventFilter::Within(const Vector3& center, float radius, uint32_t requiredTags)
+{
+    EventFilter filter;
+    filter.requiredTags = requiredTags;
+    filter.spatial = true;
+    filter.center = center;
+    filter.radius = radius;
+    return filter;
+}
+
+void EventBus::Flush(const SceneManager& sceneMgr)
+{
+    const TransformStorage& sceneStorage = sceneMgr.GetTransformStorage();
+    if (storage != &sceneStorage || storageLayoutVersion != sceneStorage.GetLayoutVersion())
+    {
+        // Rebuilt on demand by FindSlot()
+        storage = &sceneStorage;
+        storageLayoutVersion = UINT64_MAX;
+        ++slotsVersion;
+    }
+    
+    // Topics can be created by handlers, so don't hold an iterator
+    for (size_t i = 0; i < topics.size(); ++i)
+    {
+        topics[i]->Deliver(*this);
+    }
+}
+
+void EventBus::RemoveObjects(const std::vector<int>& sortedIDs)
+{
+    for (EventTopicBase* topic : topics)
+    {
+        topic->RemoveObjects(sortedIDs);
+    }
+}
+
+size_t EventBus::FindSlot(int objectID)
+{
+    if (storageLayoutVersion != storage->GetLayoutVersion())
+    {
+        const TransformBuffer& transforms = storage->GetTransforms();
+        slotByObject.clear();
+        slotByObject.reserve(transforms.GetCount());
+        for (size_t i = 0; i < transforms.GetCount(); ++i)
+        {
+            slotByObject.emplace(transforms.objectIDs[i], i);
+        }
+        
+        storageLayoutVersion = storage->GetLayoutVersion();
+    }
+    
+    auto it = slotByObject.find(objectID);
+    return it != slotByObject.end() ? it->second : NoSlot;
+}
+}
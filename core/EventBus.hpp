@@ -0,0 +1,351 @@
+#pragma once
+
+#include <cfloat>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+#include "TransformStorage.hpp"
+#include "../math/Vector3.hpp"
+
+namespace Core
+{
+class SceneManager;
+class EventBus;
+
+// Narrows down which subscribers a published event reaches
+struct EventFilter
+{
+    // Subscribers need every one of these tag bits
+    uint32_t requiredTags = 0;
+    
+    // Subscribers need a transform within 'radius' of 'center'
+    bool spatial = false;
+    Vector3 center;
+    float radius = 0.0f;
+    
+    static EventFilter Tags(uint32_t requiredTags);
+    static EventFilter Within(const Vector3& center, float radius, uint32_t requiredTags = 0);
+};
+
+// Untyped interface the bus uses to flush and clean up every topic
+class EventTopicBase
+{
+public:
+    virtual ~EventTopicBase() {}
+    
+    virtual void Deliver(EventBus& bus) = 0;
+    virtual void RemoveObjects(const std::vector<int>& sortedIDs) = 0;
+    virtual size_t GetSubscriberCount() const = 0;
+};
+
+// Subscribers to one event type, kept in parallel arrays so matching an event
+// against all of them is a single pass with no lookups.
+template <typename Event>
+class EventTopic : public EventTopicBase
+{
+public:
+    typedef std::function<void(int objectID, const Event& event)> Handler;
+    
+    void Subscribe(int objectID, Handler handler, uint32_t tags);
+    bool Unsubscribe(int objectID);
+    void Publish(const Event& event, const EventFilter& filter) { pending.push_back(PendingEvent{ event, filter }); }
+    
+    void Deliver(EventBus& bus) override;
+    void RemoveObjects(const std::vector<int>& sortedIDs) override;
+    size_t GetSubscriberCount() const override { return objectIDs.size(); }
+    
+private:
+    struct PendingEvent
+    {
+        Event event;
+        EventFilter filter;
+    };
+    
+    // Subscription changes made by handlers, applied once delivery is done
+    struct Change
+    {
+        int objectID;
+        Handler handler;    // Empty to unsubscribe
+        uint32_t tags;
+    };
+    
+    void Apply(Change& change);
+    
+    // Fills 'matches' with the subscribers that pass the filter
+    size_t Match(const EventFilter& filter, EventBus& bus);
+    
+private:
+    std::vector<int> objectIDs;
+    std::vector<uint32_t> tags;
+    std::vector<Handler> handlers;
+    std::unordered_map<int, size_t> indexByObject;
+    
+    // Each subscriber's TransformStorage slot, for spatial filters
+    std::vector<size_t> slots;
+    uint64_t slotsVersion = UINT64_MAX;
+    
+    std::vector<PendingEvent> pending;
+    std::vector<PendingEvent> delivering;
+    std::vector<uint32_t> matches;
+    std::vector<Change> changes;
+    bool isDelivering = false;
+};
+
+// Publish/subscribe for events that concern many objects at once ("explosion
+// at P") instead of a message to a single target. Each event type is its own
+// topic. Published events wait until Flush(), which runs topic by topic, in
+// publish order within a topic, matching each event against the whole
+// subscriber list in one linear pass.
+//
+//     bus.Subscribe<ExplosionEvent>(id, [](int objectID, const ExplosionEvent& e) { ... });
+//     bus.Publish(ExplosionEvent{ ... }, EventFilter::Within(position, 20.0f));
+//
+// An object has at most one subscription per topic; subscribing again
+// replaces it. Handlers may subscribe, unsubscribe and publish, those take
+// effect once the current topic has been delivered.
+class EventBus
+{
+public:
+    template <typename Event>
+    void Subscribe(int objectID, typename EventTopic<Event>::Handler handler, uint32_t tags = 0)
+    {
+        GetTopic<Event>().Subscribe(objectID, std::move(handler), tags);
+    }
+    
+    // Returns false if the object wasn't subscribed
+    template <typename Event>
+    bool Unsubscribe(int objectID)
+    {
+        return GetTopic<Event>().Unsubscribe(objectID);
+    }
+    
+    template <typename Event>
+    void Publish(const Event& event, const EventFilter& filter = EventFilter())
+    {
+        GetTopic<Event>().Publish(event, filter);
+    }
+    
+    template <typename Event>
+    size_t GetSubscriberCount()
+    {
+        return GetTopic<Event>().GetSubscriberCount();
+    }
+    
+    // Delivers everything published so far. Spatial filters use the scene's
+    // current transforms.
+    void Flush(const SceneManager& sceneMgr);
+    
+    // Drops every subscription held by one of the (sorted) object IDs
+    void RemoveObjects(const std::vector<int>& sortedIDs);
+    
+    // Only valid during Flush(). FindSlot returns NoSlot for objects without
+    // a transform in the scene.
+    static const size_t NoSlot = SIZE_MAX;
+    const TransformStorage& GetStorage() const { return *storage; }
+    uint64_t GetSlotsVersion() const { return slotsVersion; }
+    size_t FindSlot(int objectID);
+    
+private:
+    template <typename Event>
+    EventTopic<Event>& GetTopic()
+    {
+        std::unique_ptr<EventTopicBase>& topic = topicsByType[std::type_index(typeid(Event))];
+        if (topic == nullptr)
+        {
+            topic = std::make_unique<EventTopic<Event>>();
+            topics.push_back(topic.get());
+        }
+        
+        return static_cast<EventTopic<Event>&>(*topic);
+    }
+    
+private:
+    std::unordered_map<std::type_index, std::unique_ptr<EventTopicBase>> topicsByType;
+    std::vector<EventTopicBase*> topics;    // In creation order, for a stable flush order
+    
+    // Object ID to storage slot, built the first time a flush needs it
+    const TransformStorage* storage = nullptr;
+    uint64_t storageLayoutVersion = UINT64_MAX;
+    uint64_t slotsVersion = 0;
+    std::unordered_map<int, size_t> slotByObject;
+};
+
+template <typename Event>
+void EventTopic<Event>::Subscribe(int objectID, Handler handler, uint32_t subscriberTags)
+{
+    Change change{ objectID, std::move(handler), subscriberTags };
+    if (isDelivering)
+    {
+        changes.push_back(std::move(change));
+    }
+    else
+    {
+        Apply(change);
+    }
+}
+
+template <typename Event>
+bool EventTopic<Event>::Unsubscribe(int objectID)
+{
+    bool subscribed = indexByObject.find(objectID) != indexByObject.end();
+    
+    Change change{ objectID, Handler(), 0 };
+    if (isDelivering)
+    {
+        changes.push_back(std::move(change));
+    }
+    else
+    {
+        Apply(change);
+    }
+    
+    return subscribed;
+}
+
+template <typename Event>
+void EventTopic<Event>::Apply(Change& change)
+{
+    auto it = indexByObject.find(change.objectID);
+    
+    if (change.handler)
+    {
+        if (it != indexByObject.end())
+        {
+            handlers[it->second] = std::move(change.handler);
+            tags[it->second] = change.tags;
+            return;
+        }
+        
+        indexByObject[change.objectID] = objectIDs.size();
+        objectIDs.push_back(change.objectID);
+        tags.push_back(change.tags);
+        handlers.push_back(std::move(change.handler));
+        slotsVersion = UINT64_MAX;
+        return;
+    }
+    
+    if (it == indexByObject.end())
+    {
+        return;
+    }
+    
+    // Swap the last subscriber into the hole
+    size_t index = it->second;
+    size_t last = objectIDs.size() - 1;
+    indexByObject.erase(it);
+    if (index != last)
+    {
+        objectIDs[index] = objectIDs[last];
+        tags[index] = tags[last];
+        handlers[index] = std::move(handlers[last]);
+        indexByObject[objectIDs[index]] = index;
+    }
+    
+    objectIDs.pop_back();
+    tags.pop_back();
+    handlers.pop_back();
+    slotsVersion = UINT64_MAX;
+}
+
+template <typename Event>
+void EventTopic<Event>::Deliver(EventBus& bus)
+{
+    if (pending.empty())
+    {
+        return;
+    }
+    
+    // Events published by handlers wait for the next flush
+    delivering.swap(pending);
+    isDelivering = true;
+    
+    for (const PendingEvent& published : delivering)
+    {
+        size_t count = Match(published.filter, bus);
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32_t subscriber = matches[i];
+            handlers[subscriber](objectIDs[subscriber], published.event);
+        }
+    }
+    
+    isDelivering = false;
+    delivering.clear();
+    
+    for (Change& change : changes)
+    {
+        Apply(change);
+    }
+    
+    changes.clear();
+}
+
+template <typename Event>
+size_t EventTopic<Event>::Match(const EventFilter& filter, EventBus& bus)
+{
+    const size_t count = objectIDs.size();
+    const uint32_t required = filter.requiredTags;
+    matches.resize(count);
+    size_t matched = 0;
+    
+    if (!filter.spatial)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            matches[matched] = static_cast<uint32_t>(i);
+            matched += (tags[i] & required) == required;
+        }
+        
+        return matched;
+    }
+    
+    const TransformBuffer& transforms = bus.GetStorage().GetTransforms();
+    if (transforms.GetCount() == 0)
+    {
+        return 0;
+    }
+    
+    if (slotsVersion != bus.GetSlotsVersion())
+    {
+        slots.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            slots[i] = bus.FindSlot(objectIDs[i]);
+        }
+        
+        slotsVersion = bus.GetSlotsVersion();
+    }
+    
+    const float radiusSqr = filter.radius * filter.radius;
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t slot = slots[i];
+        bool hasTransform = slot != EventBus::NoSlot;
+        size_t at = hasTransform ? slot : 0;
+        
+        float dx = transforms.px[at] - filter.center.x;
+        float dy = transforms.py[at] - filter.center.y;
+        float dz = transforms.pz[at] - filter.center.z;
+        
+        matches[matched] = static_cast<uint32_t>(i);
+        matched += hasTransform & ((tags[i] & required) == required) & (dx * dx + dy * dy + dz * dz <= radiusSqr);
+    }
+    
+    return matched;
+}
+
+template <typename Event>
+void EventTopic<Event>::RemoveObjects(const std::vector<int>& sortedIDs)
+{
+    for (int objectID : sortedIDs)
+    {
+        if (indexByObject.find(objectID) != indexByObject.end())
+        {
+            Unsubscribe(objectID);
+        }
+    }
+}
+}
@@ -0,0 +1,92 @@
+#include <chrono>
+#include "FrameLoop.hpp"
+#include "MessageLog.hpp"
+#include "SceneManager.hpp"
+#include "TelemetryServer.hpp"
+
+namespace Core
+{
+FrameLoop::FrameLoop(SceneManager& sceneMgr, float stepSeconds) :
+    sceneMgr(sceneMgr),
+    stepSeconds(stepSeconds)
+{
+    // Start with both buffers holding the current state so the first
+    // interpolation has something sensible to blend from.
+    buffers[0].Capture(sceneMgr);
+    buffers[1].Capture(sceneMgr);
+}
+
+int FrameLoop::Tick(float frameSeconds)
+{
+    accumulator += frameSeconds;
+    
+    int steps = 0;
+    while (accumulator >= stepSeconds && steps < maxStepsPerTick)
+    {
+        Step();
+        accumulator -= stepSeconds;
+        ++steps;
+    }
+    
+    // Drop whatever time we couldn't catch up on
+    if (accumulator >= stepSeconds)
+    {
+        accumulator = 0.0f;
+    }
+    
+    return steps;
+}
+
+void FrameLoop::Interpolate(TransformBuffer& out) const
+{
+    TransformBuffer::Interpolate(GetPreviousTransforms(), GetCurrentTransforms(), GetAlpha(), out);
+}
+
+void FrameLoop::RebaseOrigin(const Vector3d& newOrigin)
+{
+    Vector3 offset = sceneMgr.RebaseOrigin(newOrigin);
+    
+    for (TransformBuffer& buffer : buffers)
+    {
+        buffer.Translate(offset, 0, buffer.GetCount());
+    }
+}
+
+void FrameLoop::Step()
+{
+    std::chrono::steady_clock::time_point start;
+    if (telemetry != nullptr)
+    {
+        start = std::chrono::steady_clock::now();
+    }
+    
+    if (stepCallback)
+    {
+        stepCallback(stepSeconds);
+    }
+    
+    sceneMgr.FlushMessages();
+    sceneMgr.FlushEvents();
+    integrationSystem.Integrate(sceneMgr, stepSeconds);
+    sceneMgr.FlushQueries();
+    sceneMgr.UpdateTasks(stepSeconds);
+    
+    // The old previous buffer becomes the new current one
+    currentIndex ^= 1;
+    buffers[currentIndex].Capture(sceneMgr);
+    ++stepCount;
+    
+    sceneMgr.PublishSnapshot(stepCount);
+    
+    if (MessageRecorder* recorder = sceneMgr.GetMessageRecorder())
+    {
+        recorder->EndFrame(stepSeconds);
+    }
+    
+    if (telemetry != nullptr)
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        telemetry->RecordFrame(sceneMgr, static_cast<uint64_t>(elapsed.count()));
+    }
+}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <functional>
+#include "TransformBuffer.hpp"
+#include "../systems/IntegrationSystem.hpp"
+
+namespace Core
+{
+class SceneManager;
+class TelemetryServer;
+
+// Runs the simulation at a fixed timestep no matter how often Tick() is
+// called, and keeps the transforms from the last two steps so rendering (or
+// anything else running at its own rate) can interpolate between them.
+//
+// Both buffers belong to the thread calling Tick(): each step recaptures
+// into the one that was previous. Other threads should read the scene's
+// published snapshots (SceneManager::GetSnapshots()) instead, which every
+// step also updates.
+class FrameLoop
+{
+public:
+    typedef std::function<void(float stepSeconds)> StepCallback;
+    
+    FrameLoop(SceneManager& sceneMgr, float stepSeconds = 1.0f / 60.0f);
+    
+    // Game logic to run each simulation step, before queued messages and
+    // events are flushed, velocities are integrated and tasks are resumed.
+    void SetStepCallback(StepCallback callback) { stepCallback = callback; }
+    
+    // Caps how many steps one Tick() will run, so a long hitch can't make
+    // every following frame slower as it tries to catch up.
+    void SetMaxStepsPerTick(int maxSteps) { maxStepsPerTick = maxSteps; }
+    
+    // Reports every step's duration and the scene's counts to the server.
+    // Pass nullptr to detach.
+    void SetTelemetry(TelemetryServer* server) { telemetry = server; }
+    
+    // Advances real time and runs as many whole steps as fit. Returns the
+    // number of steps run.
+    int Tick(float frameSeconds);
+    
+    // How far between the previous and current step the leftover time puts us, 0-1
+    float GetAlpha() const { return accumulator / stepSeconds; }
+    
+    float GetStepSeconds() const { return stepSeconds; }
+    uint64_t GetStepCount() const { return stepCount; }
+    
+    const TransformBuffer& GetPreviousTransforms() const { return buffers[currentIndex ^ 1]; }
+    const TransformBuffer& GetCurrentTransforms() const { return buffers[currentIndex]; }
+    
+    // Fills 'out' with transforms blended to the current alpha
+    void Interpolate(TransformBuffer& out) const;
+    
+    IntegrationSystem& GetIntegrationSystem() { return integrationSystem; }
+    
+    // Rebases the scene (see SceneManager::RebaseOrigin) and both step
+    // buffers with it, so interpolation doesn't see a jump
+    void RebaseOrigin(const Vector3d& newOrigin);
+    
+private:
+    void Step();
+    
+private:
+    SceneManager& sceneMgr;
+    StepCallback stepCallback;
+    TelemetryServer* telemetry = nullptr;
+    IntegrationSystem integrationSystem;
+    float stepSeconds;
+    float accumulator = 0.0f;
+    int maxStepsPerTick = 8;
+    uint64_t stepCount = 0;
+    
+    TransformBuffer buffers[2];
+    int currentIndex = 0;
+};
+}
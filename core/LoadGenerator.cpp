@@ -0,0 +1,225 @@
+#include <chrono>
+#include "LoadGenerator.hpp"
+#include "FrameLoop.hpp"
+#include "MessageStats.hpp"
+#include "SceneManager.hpp"
+#include "../components/AngularVelocityComponent.hpp"
+#include "../components/BoundsComponent.hpp"
+#include "../components/TransformComponent.hpp"
+#include "../components/VelocityComponent.hpp"
+#include "../messages/GetPositionMessage.hpp"
+#include "../messages/SetPositionMessage.hpp"
+#include "../messages/SetRotationMessage.hpp"
+#include "../math/Math.hpp"
+
+namespace Core
+{
+static size_t GetTrackedBytes()
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < static_cast<size_t>(MemoryCategory::Count); ++i)
+    {
+        bytes += MemoryTracker::GetUsage(static_cast<MemoryCategory>(i)).currentBytes;
+    }
+    
+    return bytes;
+}
+
+LoadResult LoadGenerator::Run(const LoadProfile& profile)
+{
+    typedef std::chrono::steady_clock Clock;
+    
+    LoadResult result;
+    result.profile = profile;
+    size_t trackedBefore = GetTrackedBytes();
+    
+    SceneManager sceneMgr;
+    
+    Prefab prefab;
+    prefab.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    if (profile.componentsPerObject >= 2)
+    {
+        prefab.AddComponent<VelocityComponent>(Vector3::Zero);
+    }
+    if (profile.componentsPerObject >= 3)
+    {
+        prefab.AddComponent<AngularVelocityComponent>(Vector3::Zero);
+    }
+    if (profile.componentsPerObject >= 4)
+    {
+        prefab.AddComponent<BoundsComponent>(Vector3::Zero, Vector3::One);
+    }
+    
+    Clock::time_point buildStart = Clock::now();
+    int firstID = sceneMgr.CreateObjects(profile.objectCount, prefab);
+    result.buildMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - buildStart).count();
+    
+    uint32_t seed = profile.seed;
+    auto random = [&seed]()
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return seed;
+    };
+    auto randomUnit = [&random]()
+    {
+        return (float)(random() >> 8) / 16777216.0f;
+    };
+    
+    // Weights as cumulative thresholds
+    float totalWeight = profile.setPositionWeight + profile.getPositionWeight + profile.setRotationWeight + profile.getRotationWeight;
+    float setPositionLimit = profile.setPositionWeight / totalWeight;
+    float getPositionLimit = setPositionLimit + profile.getPositionWeight / totalWeight;
+    float setRotationLimit = getPositionLimit + profile.setRotationWeight / totalWeight;
+    
+    uint32_t objectCount = static_cast<uint32_t>(profile.objectCount);
+    uint32_t hotCount = static_cast<uint32_t>(profile.objectCount * profile.hotObjectShare);
+    if (hotCount == 0)
+    {
+        hotCount = 1;
+    }
+    
+    FrameLoop loop(sceneMgr);
+    loop.SetStepCallback([&](float)
+    {
+        for (size_t i = 0; i < profile.messagesPerFrame; ++i)
+        {
+            uint32_t pick = randomUnit() < profile.hotMessageShare ? random() % hotCount : random() % objectCount;
+            int target = firstID + static_cast<int>(pick);
+            
+            float kind = randomUnit();
+            if (kind < setPositionLimit)
+            {
+                SetPositionMessage msg(target, Vector3(randomUnit(), randomUnit(), randomUnit()));
+                if (profile.queueSets)
+                {
+                    sceneMgr.QueueMessage(msg);
+                }
+                else
+                {
+                    sceneMgr.SendMessage(&msg);
+                }
+            }
+            else if (kind < getPositionLimit)
+            {
+                GetPositionMessage msg(target);
+                sceneMgr.SendMessage(&msg);
+            }
+            else if (kind < setRotationLimit)
+            {
+                SetRotationMessage msg(target, Quaternion(randomUnit() * Math::Pi, Vector3::Up));
+                if (profile.queueSets)
+                {
+                    sceneMgr.QueueMessage(msg);
+                }
+                else
+                {
+                    sceneMgr.SendMessage(&msg);
+                }
+            }
+            else
+            {
+                sceneMgr.QueryRotation(target);
+            }
+        }
+    });
+    
+    for (int frame = 0; frame < profile.warmupFrames; ++frame)
+    {
+        loop.Tick(loop.GetStepSeconds());
+    }
+    
+    HardwareCounters counters;
+    LatencyHistogram frameTimes;
+    HardwareCounters::Values countersBefore = counters.Read();
+    Clock::time_point start = Clock::now();
+    
+    for (int frame = 0; frame < profile.frames; ++frame)
+    {
+        Clock::time_point frameStart = Clock::now();
+        loop.Tick(loop.GetStepSeconds());
+        frameTimes.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - frameStart).count());
+    }
+    
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.counters = counters.Read() - countersBefore;
+    
+    result.messagesPerSecond = seconds > 0.0 ? profile.messagesPerFrame * profile.frames / seconds : 0.0;
+    result.frameP50Milliseconds = frameTimes.GetValueAtPercentile(50.0) / 1e6;
+    result.frameP90Milliseconds = frameTimes.GetValueAtPercentile(90.0) / 1e6;
+    result.frameP99Milliseconds = frameTimes.GetValueAtPercentile(99.0) / 1e6;
+    result.frameMaxMilliseconds = frameTimes.GetMax() / 1e6;
+    result.memoryBytes = GetTrackedBytes() - trackedBefore + sceneMgr.GetTransformStorage().GetMemoryUsage();
+    
+    return result;
+}
+
+std::vector<LoadResult> LoadGenerator::Sweep(const LoadProfile& base, const std::vector<size_t>& objectCounts,
+                                             const std::vector<int>& componentCounts, const std::vector<size_t>& messageRates,
+                                             std::ostream* out)
+{
+    if (out != nullptr)
+    {
+        WriteCSVHeader(*out);
+    }
+    
+    std::vector<LoadResult> results;
+    for (size_t objectCount : objectCounts)
+    {
+        for (int components : componentCounts)
+        {
+            for (size_t messageRate : messageRates)
+            {
+                LoadProfile profile = base;
+                profile.objectCount = objectCount;
+                profile.componentsPerObject = components;
+                profile.messagesPerFrame = messageRate;
+                
+                results.push_back(Run(profile));
+                if (out != nullptr)
+                {
+                    WriteCSVRow(*out, results.back());
+                }
+            }
+        }
+    }
+    
+    return results;
+}
+
+void LoadGenerator::WriteCSVHeader(std::ostream& out)
+{
+    out << "objects,components,messages_per_frame,build_ms,messages_per_sec,"
+        << "frame_p50_ms,frame_p90_ms,frame_p99_ms,frame_max_ms,bytes_per_object,"
+        << "main_ipc,main_l1d_misses_per_msg,main_llc_misses_per_msg,main_branch_misses_per_msg" << std::endl;
+}
+
+void LoadGenerator::WriteCSVRow(std::ostream& out, const LoadResult& result)
+{
+    const LoadProfile& profile = result.profile;
+    uint64_t messages = profile.messagesPerFrame * profile.frames;
+    
+    out << profile.objectCount << "," << profile.componentsPerObject << "," << profile.messagesPerFrame << ","
+        << result.buildMilliseconds << "," << static_cast<uint64_t>(result.messagesPerSecond) << ","
+        << result.frameP50Milliseconds << "," << result.frameP90Milliseconds << ","
+        << result.frameP99Milliseconds << "," << result.frameMaxMilliseconds << ","
+        << (profile.objectCount > 0 ? result.memoryBytes / profile.objectCount : 0) << ",";
+    
+    // Empty columns where counters weren't available
+    const HardwareCounters::Values& counters = result.counters;
+    if (counters.Has(HardwareCounters::Cycles) && counters.Has(HardwareCounters::Instructions))
+    {
+        out << counters.GetIPC();
+    }
+    
+    const HardwareCounters::Counter perMessage[] = { HardwareCounters::L1DataMisses, HardwareCounters::LastLevelCacheMisses, HardwareCounters::BranchMisses };
+    for (HardwareCounters::Counter counter : perMessage)
+    {
+        out << ",";
+        if (counters.Has(counter))
+        {
+            out << counters.GetRate(counter, messages);
+        }
+    }
+    out << std::endl;
+}
+}
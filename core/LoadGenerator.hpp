@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "../time/HardwareCounters.hpp"
+
+namespace Core
+{
+// What a synthetic scene looks like and how hard it gets driven
+struct LoadProfile
+{
+    size_t objectCount = 10000;
+    
+    // 1-4: Transform, then Velocity, AngularVelocity and Bounds
+    int componentsPerObject = 1;
+    
+    size_t messagesPerFrame = 10000;
+    int frames = 60;
+    int warmupFrames = 5;
+    
+    // Message mix, as relative weights. GetRotation goes through the query API
+    // since it has no message class.
+    float setPositionWeight = 4.0f;
+    float getPositionWeight = 3.0f;
+    float setRotationWeight = 2.0f;
+    float getRotationWeight = 1.0f;
+    
+    // Real scenes don't spread messages evenly: this share of the messages
+    // goes to this share of the objects, the rest anywhere.
+    float hotObjectShare = 0.1f;
+    float hotMessageShare = 0.8f;
+    
+    // Queue the Set* messages for the frame's flush instead of sending them
+    bool queueSets = false;
+    
+    uint32_t seed = 1;
+};
+
+struct LoadResult
+{
+    LoadProfile profile;
+    double buildMilliseconds = 0.0;
+    double messagesPerSecond = 0.0;
+    
+    // Per-frame time, sending the frame's messages plus one simulation step
+    double frameP50Milliseconds = 0.0;
+    double frameP90Milliseconds = 0.0;
+    double frameP99Milliseconds = 0.0;
+    double frameMaxMilliseconds = 0.0;
+    
+    // Tracked heap and transform storage used by the scene
+    size_t memoryBytes = 0;
+    
+    // Over the measured frames, on the thread that ran them only. Work the
+    // systems hand to ThreadPool workers isn't counted, so the CSV columns
+    // are prefixed main_.
+    HardwareCounters::Values counters;
+};
+
+// Builds synthetic scenes and drives them with a randomized message mix to
+// see how the engine scales with object count, components and message rate.
+class LoadGenerator
+{
+public:
+    static LoadResult Run(const LoadProfile& profile);
+    
+    // Runs every combination, in order, writing a CSV row to 'out' (if given)
+    // as each one finishes
+    static std::vector<LoadResult> Sweep(const LoadProfile& base, const std::vector<size_t>& objectCounts,
+                                         const std::vector<int>& componentCounts, const std::vector<size_t>& messageRates,
+                                         std::ostream* out = nullptr);
+    
+    static void WriteCSVHeader(std::ostream& out);
+    static void WriteCSVRow(std::ostream& out, const LoadResult& result);
+};
+}
@@ -0,0 +1,100 @@
+#include "MemoryTracker.hpp"
+
+namespace Core
+{
+MemoryTracker::Counters MemoryTracker::counters[static_cast<size_t>(MemoryCategory::Count)];
+
+void* MemoryTracker::Allocate(MemoryCategory category, size_t bytes, size_t alignment)
+{
+    void* memory = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+        ? ::operator new(bytes, std::align_val_t(alignment))
+        : ::operator new(bytes);
+    
+    Counters& counter = counters[static_cast<size_t>(category)];
+    size_t current = counter.currentBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    counter.allocations.fetch_add(1, std::memory_order_relaxed);
+    
+    size_t peak = counter.peakBytes.load(std::memory_order_relaxed);
+    while (current > peak && !counter.peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+    {
+    }
+    
+    return memory;
+}
+
+void MemoryTracker::Free(MemoryCategory category, void* memory, size_t bytes, size_t alignment)
+{
+    if (memory == nullptr)
+    {
+        return;
+    }
+    
+    counters[static_cast<size_t>(category)].currentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        ::operator delete(memory, std::align_val_t(alignment));
+    }
+    else
+    {
+        ::operator delete(memory);
+    }
+}
+
+MemoryTracker::Usage MemoryTracker::GetUsage(MemoryCategory category)
+{
+    const Counters& counter = counters[static_cast<size_t>(category)];
+    return Usage{ counter.currentBytes.load(std::memory_order_relaxed),
+                  counter.peakBytes.load(std::memory_order_relaxed),
+                  counter.allocations.load(std::memory_order_relaxed) };
+}
+
+const char* MemoryTracker::GetCategoryName(MemoryCategory category)
+{
+    switch (category)
+    {
+        case MemoryCategory::Objects: return "Objects";
+        case MemoryCategory::Components: return "Components";
+        case MemoryCategory::Messages: return "Messages";
+        default: return "Unknown";
+    }
+}
+
+void MemoryTracker::ResetPeaks()
+{
+    for (Counters& counter : counters)
+    {
+        counter.peakBytes.store(counter.currentBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+void MemoryUsageReport::Write(std::ostream& out) const
+{
+    out << "Tracked heap (all scenes):" << std::endl;
+    for (size_t i = 0; i < static_cast<size_t>(MemoryCategory::Count); ++i)
+    {
+        out << "  " << MemoryTracker::GetCategoryName(static_cast<MemoryCategory>(i))
+            << ": " << categories[i].currentBytes << " bytes, peak " << categories[i].peakBytes
+            << ", " << categories[i].allocations << " allocations" << std::endl;
+    }
+    
+    out << "Scene:" << std::endl;
+    out << "  " << objectCount << " objects: " << objectBytes << " bytes";
+    if (objectCount > 0)
+    {
+        out << " (" << objectBytes / objectCount << " per object)";
+    }
+    out << std::endl;
+    out << "  Object list slack: " << objectListSlackBytes << " bytes" << std::endl;
+    
+    for (const ComponentTypeUsage& usage : componentTypes)
+    {
+        out << "  " << usage.name << ": " << usage.count << " components, " << usage.bytes << " bytes" << std::endl;
+    }
+    
+    out << "  Message handlers (not in the tracked heap): " << handlerTableCount << " tables, " << handlerTableBytes << " bytes, "
+        << componentsWithOwnHandlers << " components with their own table" << std::endl;
+    out << "  Pending messages: " << pendingMessages << std::endl;
+    out << "  Transform storage: " << transformStorageBytes << " bytes" << std::endl;
+}
+}
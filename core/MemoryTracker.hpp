@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Core
+{
+enum class MemoryCategory
+{
+    Objects = 0,    // Objects, their component lists, the scene's object indexes and their shared_ptr control blocks
+    Components,     // Component instances, prefab defaults and their shared_ptr control blocks
+    Messages,       // Heap messages (queued clones) and the queue itself
+    
+    Count   // Must remain last
+};
+
+// Process-wide heap usage per category, fed by TrackingAllocator and the
+// tracked operator new/delete of BaseMessage and Component. Counters are
+// atomic, so tracked allocations can happen on any thread.
+class MemoryTracker
+{
+public:
+    struct Usage
+    {
+        size_t currentBytes;
+        size_t peakBytes;       // High-water mark since start or ResetPeaks()
+        uint64_t allocations;   // Total allocations made, not currently live
+    };
+    
+    static void* Allocate(MemoryCategory category, size_t bytes, size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    static void Free(MemoryCategory category, void* memory, size_t bytes, size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    
+    static Usage GetUsage(MemoryCategory category);
+    static const char* GetCategoryName(MemoryCategory category);
+    
+    // Starts the high-water marks again from current usage
+    static void ResetPeaks();
+    
+private:
+    struct Counters
+    {
+        std::atomic<size_t> currentBytes{ 0 };
+        std::atomic<size_t> peakBytes{ 0 };
+        std::atomic<uint64_t> allocations{ 0 };
+    };
+    
+    static Counters counters[static_cast<size_t>(MemoryCategory::Count)];
+};
+
+// Standard allocator that counts towards a MemoryCategory
+template <typename T, MemoryCategory Category>
+class TrackingAllocator
+{
+public:
+    typedef T value_type;
+    
+    template <typename U>
+    struct rebind
+    {
+        typedef TrackingAllocator<U, Category> other;
+    };
+    
+    TrackingAllocator() noexcept {}
+    
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U, Category>&) noexcept {}
+    
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(MemoryTracker::Allocate(Category, count * sizeof(T), alignof(T)));
+    }
+    
+    void deallocate(T* memory, size_t count) noexcept
+    {
+        MemoryTracker::Free(Category, memory, count * sizeof(T), alignof(T));
+    }
+    
+    template <typename U>
+    bool operator==(const TrackingAllocator<U, Category>&) const noexcept { return true; }
+    
+    template <typename U>
+    bool operator!=(const TrackingAllocator<U, Category>&) const noexcept { return false; }
+};
+
+// Footprint of one scene, see SceneManager::MemoryReport()
+struct MemoryUsageReport
+{
+    struct ComponentTypeUsage
+    {
+        std::string name;
+        size_t count;
+        size_t bytes;           // count * size of the type, 0 if unregistered
+    };
+    
+    // Process-wide, from the trackers
+    MemoryTracker::Usage categories[static_cast<size_t>(MemoryCategory::Count)];
+    
+    // This scene, counted by walking it
+    size_t objectCount = 0;
+    size_t objectBytes = 0;     // Objects plus their component lists and index entries
+    size_t objectListSlackBytes = 0;    // Reserved but unused space in the scene's object list
+    std::vector<ComponentTypeUsage> componentTypes;
+    size_t handlerTableCount = 0;       // Distinct tables, shared ones counted once
+    size_t handlerTableBytes = 0;
+    size_t componentsWithOwnHandlers = 0;
+    size_t pendingMessages = 0;
+    size_t transformStorageBytes = 0;
+    
+    void Write(std::ostream& out) const;
+};
+}
@@ -0,0 +1,317 @@
+#include <cstring>
+#include <iterator>
+#include <thread>
+#include "MessageLog.hpp"
+#include "SceneManager.hpp"
+#include "../messages/GetPositionMessage.hpp"
+#include "../messages/SetAngularVelocityMessage.hpp"
+#include "../messages/SetPositionMessage.hpp"
+#include "../messages/SetRotationMessage.hpp"
+#include "../messages/SetVelocityMessage.hpp"
+
+namespace Core
+{
+static const uint8_t s_header[] = { 'M', 'L', 'O', 'G', MessageLog::Version };
+
+MessageRecorder::MessageRecorder(std::ostream& out) :
+    out(out),
+    start(std::chrono::steady_clock::now())
+{
+    buffer.assign(std::begin(s_header), std::end(s_header));
+}
+
+MessageRecorder::~MessageRecorder()
+{
+    WriteBuffer();
+}
+
+bool MessageRecorder::Record(const BaseMessage& msg)
+{
+    MessageType type = msg.GetType();
+    if (type == MessageType::AddComponent)
+    {
+        ++skippedCount;
+        return false;
+    }
+    
+    // Targets tend to repeat or walk forward, so deltas stay small
+    int64_t delta = static_cast<int64_t>(msg.GetTargetObjectID()) - previousTarget;
+    previousTarget = msg.GetTargetObjectID();
+    
+    buffer.push_back(static_cast<uint8_t>(type));
+    WriteVarint(static_cast<uint64_t>((delta << 1) ^ (delta >> 63)));
+    
+    switch (type)
+    {
+        case MessageType::SetPosition:
+        {
+            const Vector3& position = static_cast<const SetPositionMessage&>(msg).position;
+            WriteFloat(position.x);
+            WriteFloat(position.y);
+            WriteFloat(position.z);
+            break;
+        }
+        case MessageType::SetRotation:
+        {
+            const Quaternion& rotation = static_cast<const SetRotationMessage&>(msg).rotation;
+            WriteFloat(rotation.w);
+            WriteFloat(rotation.x);
+            WriteFloat(rotation.y);
+            WriteFloat(rotation.z);
+            break;
+        }
+        case MessageType::SetVelocity:
+        {
+            const Vector3& velocity = static_cast<const SetVelocityMessage&>(msg).velocity;
+            WriteFloat(velocity.x);
+            WriteFloat(velocity.y);
+            WriteFloat(velocity.z);
+            break;
+        }
+        case MessageType::SetAngularVelocity:
+        {
+            const Vector3& angularVelocity = static_cast<const SetAngularVelocityMessage&>(msg).angularVelocity;
+            WriteFloat(angularVelocity.x);
+            WriteFloat(angularVelocity.y);
+            WriteFloat(angularVelocity.z);
+            break;
+        }
+        default:
+            // Queries have no payload, only their cost is worth replaying
+            break;
+    }
+    
+    ++messageCount;
+    return true;
+}
+
+void MessageRecorder::EndFrame(float deltaSeconds)
+{
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    
+    buffer.push_back(MessageLog::FrameTag);
+    WriteFloat(deltaSeconds);
+    WriteVarint(static_cast<uint64_t>(elapsed.count()));
+    ++frameCount;
+    
+    WriteBuffer();
+}
+
+void MessageRecorder::WriteVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buffer.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+}
+
+void MessageRecorder::WriteFloat(float value)
+{
+    uint8_t bytes[sizeof(float)];
+    std::memcpy(bytes, &value, sizeof(float));
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(float));
+}
+
+void MessageRecorder::WriteBuffer()
+{
+    if (buffer.empty())
+    {
+        return;
+    }
+    
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    bytesWritten += buffer.size();
+    buffer.clear();
+}
+
+MessageReplay::MessageReplay(std::istream& in) :
+    data(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()),
+    readOffset(sizeof(s_header))
+{
+    if (data.size() < sizeof(s_header) || std::memcmp(data.data(), s_header, 4) != 0)
+    {
+        throw "Not a message log";
+    }
+    
+    if (data[4] != MessageLog::Version)
+    {
+        throw "Unsupported message log version";
+    }
+}
+
+bool MessageReplay::ReplayFrame(SceneManager& sceneMgr, float* deltaSeconds, uint64_t* recordedMicroseconds)
+{
+    if (readOffset >= data.size())
+    {
+        return false;
+    }
+    
+    while (readOffset < data.size())
+    {
+        uint8_t tag = ReadByte();
+        if (tag == MessageLog::FrameTag)
+        {
+            float frameSeconds = ReadFloat();
+            uint64_t frameTime = ReadVarint();
+            
+            if (deltaSeconds != nullptr)
+            {
+                *deltaSeconds = frameSeconds;
+            }
+            if (recordedMicroseconds != nullptr)
+            {
+                *recordedMicroseconds = frameTime;
+            }
+            return true;
+        }
+        
+        uint64_t zigzag = ReadVarint();
+        previousTarget += static_cast<int>(static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1));
+        int target = previousTarget + objectIDOffset;
+        
+        switch (static_cast<MessageType>(tag))
+        {
+            case MessageType::GetPosition:
+            {
+                GetPositionMessage msg(target);
+                sceneMgr.SendMessage(&msg);
+                break;
+            }
+            case MessageType::SetPosition:
+            {
+                float x = ReadFloat();
+                float y = ReadFloat();
+                float z = ReadFloat();
+                SetPositionMessage msg(target, Vector3(x, y, z));
+                sceneMgr.SendMessage(&msg);
+                break;
+            }
+            case MessageType::SetRotation:
+            {
+                float w = ReadFloat();
+                float x = ReadFloat();
+                float y = ReadFloat();
+                float z = ReadFloat();
+                SetRotationMessage msg(target, Quaternion(w, x, y, z));
+                sceneMgr.SendMessage(&msg);
+                break;
+            }
+            case MessageType::SetVelocity:
+            {
+                float x = ReadFloat();
+                float y = ReadFloat();
+                float z = ReadFloat();
+                SetVelocityMessage msg(target, Vector3(x, y, z));
+                sceneMgr.SendMessage(&msg);
+                break;
+            }
+            case MessageType::SetAngularVelocity:
+            {
+                float x = ReadFloat();
+                float y = ReadFloat();
+                float z = ReadFloat();
+                SetAngularVelocityMessage msg(target, Vector3(x, y, z));
+                sceneMgr.SendMessage(&msg);
+                break;
+            }
+            case MessageType::GetRotation:
+                // No message class to send, the query API answers these
+                break;
+            default:
+                throw "Corrupt message log";
+        }
+        
+        ++replayedMessages;
+    }
+    
+    // Trailing messages with no frame boundary after them
+    if (deltaSeconds != nullptr)
+    {
+        *deltaSeconds = 0.0f;
+    }
+    return true;
+}
+
+MessageReplay::Stats MessageReplay::Replay(SceneManager& sceneMgr, Pacing pacing, FrameCallback onFrame)
+{
+    Stats stats;
+    uint64_t firstMessage = replayedMessages;
+    auto start = std::chrono::steady_clock::now();
+    
+    // Real time pacing is relative to the first frame replayed, so a replay
+    // can start part way into the log
+    bool haveBase = false;
+    uint64_t baseMicroseconds = 0;
+    
+    float deltaSeconds = 0.0f;
+    uint64_t recordedMicroseconds = 0;
+    while (ReplayFrame(sceneMgr, &deltaSeconds, &recordedMicroseconds))
+    {
+        if (onFrame)
+        {
+            onFrame(deltaSeconds);
+        }
+        ++stats.frames;
+        
+        if (pacing == Pacing::RealTime)
+        {
+            if (!haveBase)
+            {
+                baseMicroseconds = recordedMicroseconds;
+                haveBase = true;
+            }
+            std::this_thread::sleep_until(start + std::chrono::microseconds(recordedMicroseconds - baseMicroseconds));
+        }
+    }
+    
+    stats.messages = replayedMessages - firstMessage;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+void MessageReplay::Rewind()
+{
+    readOffset = sizeof(s_header);
+    previousTarget = 0;
+}
+
+uint8_t MessageReplay::ReadByte()
+{
+    if (readOffset >= data.size())
+    {
+        throw "Truncated message log";
+    }
+    return data[readOffset++];
+}
+
+uint64_t MessageReplay::ReadVarint()
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        uint8_t byte = ReadByte();
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return value;
+        }
+    }
+    
+    throw "Corrupt message log";
+}
+
+float MessageReplay::ReadFloat()
+{
+    if (data.size() - readOffset < sizeof(float))
+    {
+        throw "Truncated message log";
+    }
+    
+    float value;
+    std::memcpy(&value, data.data() + readOffset, sizeof(float));
+    readOffset += sizeof(float);
+    return value;
+}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include "BaseMessage.hpp"
+
+namespace Core
+{
+class SceneManager;
+
+// Binary log of the messages a scene delivers, split into frames, so captured
+// traffic can be fed back into a scene as a repeatable benchmark.
+//
+// Layout: a 5 byte header ("MLOG" and a version), then one record per message
+// or frame boundary. A message record is its MessageType as a byte, the change
+// in target ID from the previous message as a zigzag varint, then the payload
+// floats in native byte order. A frame record is FrameTag, the frame's length
+// in seconds as a float and the time since recording started in microseconds
+// as a varint.
+namespace MessageLog
+{
+    const uint8_t Version = 1;
+    const uint8_t FrameTag = 0xFF;
+}
+
+// Attach with SceneManager::SetMessageRecorder() to capture everything sent
+// through SendMessage(), queued messages included when they're flushed.
+// FrameLoop ends a frame after each step.
+class MessageRecorder
+{
+public:
+    explicit MessageRecorder(std::ostream& out);
+    
+    // Writes any messages sent since the last frame ended
+    ~MessageRecorder();
+    
+    // Returns false if the message can't be recorded. AddComponent carries a
+    // live component, so it is skipped and counted instead.
+    bool Record(const BaseMessage& msg);
+    
+    // Marks a frame boundary and writes the frame out
+    void EndFrame(float deltaSeconds);
+    
+    uint64_t GetMessageCount() const { return messageCount; }
+    uint64_t GetSkippedCount() const { return skippedCount; }
+    uint64_t GetFrameCount() const { return frameCount; }
+    uint64_t GetBytesWritten() const { return bytesWritten; }
+    
+private:
+    MessageRecorder(const MessageRecorder&);    // Prevent copying
+    
+    void WriteVarint(uint64_t value);
+    void WriteFloat(float value);
+    void WriteBuffer();
+    
+private:
+    std::ostream& out;
+    std::vector<uint8_t> buffer;
+    std::chrono::steady_clock::time_point start;
+    int previousTarget = 0;
+    uint64_t messageCount = 0;
+    uint64_t skippedCount = 0;
+    uint64_t frameCount = 0;
+    uint64_t bytesWritten = 0;
+};
+
+// Plays a recorded log into a scene. The whole log is read up front, so
+// replaying measures the engine rather than the disk.
+class MessageReplay
+{
+public:
+    enum class Pacing
+    {
+        FullSpeed = 0,  // Every frame as soon as the previous one is done
+        RealTime        // No frame finishes earlier than it did when recorded
+    };
+    
+    // Runs after each frame's messages, to step the simulation
+    typedef std::function<void(float deltaSeconds)> FrameCallback;
+    
+    struct Stats
+    {
+        uint64_t frames = 0;
+        uint64_t messages = 0;
+        double seconds = 0.0;
+    };
+    
+    // Throws if the stream isn't a message log this version understands
+    explicit MessageReplay(std::istream& in);
+    
+    // Added to every target ID, for scenes whose objects were given different
+    // IDs than the recorded one (such as a second scene in the same process)
+    void SetObjectIDOffset(int offset) { objectIDOffset = offset; }
+    
+    // Sends the next frame's messages. Returns false once the log is used up.
+    // Messages after the last frame boundary are treated as one more frame.
+    bool ReplayFrame(SceneManager& sceneMgr, float* deltaSeconds = nullptr, uint64_t* recordedMicroseconds = nullptr);
+    
+    // Replays all remaining frames
+    Stats Replay(SceneManager& sceneMgr, Pacing pacing = Pacing::FullSpeed, FrameCallback onFrame = FrameCallback());
+    
+    void Rewind();
+    
+    size_t GetSize() const { return data.size(); }
+    
+private:
+    uint8_t ReadByte();
+    uint64_t ReadVarint();
+    float ReadFloat();
+    
+private:
+    std::vector<uint8_t> data;
+    size_t readOffset;
+    int previousTarget = 0;
+    int objectIDOffset = 0;
+    uint64_t replayedMessages = 0;
+};
+}
@@ -0,0 +1,69 @@
+#include "MessageQueue.hpp"
+#include "SceneManager.hpp"
+
+namespace Core
+{
+MessageQueue::MessageQueue()
+{
+    ResetCoalescedCounts();
+}
+
+bool MessageQueue::Push(const BaseMessage& msg)
+{
+    if (!msg.IsLastWriterWins())
+    {
+        return false;
+    }
+    
+    uint64_t key = MakeKey(msg.GetTargetObjectID(), msg.GetType());
+    auto it = slotByKey.find(key);
+    if (it != slotByKey.end())
+    {
+        // Overwrite the earlier message in place so delivery order follows the
+        // first send for this object and type, and only the first send pays
+        // for a copy on the heap.
+        pending[it->second]->CopyFrom(msg);
+        ++coalescedCounts[static_cast<size_t>(msg.GetType())];
+        return true;
+    }
+    
+    BaseMessage* copy = msg.Clone();
+    if (copy == nullptr)
+    {
+        return false;
+    }
+    
+    slotByKey.emplace(key, pending.size());
+    pending.emplace_back(copy);
+    return true;
+}
+
+void MessageQueue::Flush(SceneManager& sceneMgr)
+{
+    // Handlers may queue more messages while we deliver, so swap the pending
+    // list out first. Those get delivered on the next flush.
+    MessageList delivering;
+    delivering.swap(pending);
+    slotByKey.clear();
+    
+    for (auto& msg : delivering)
+    {
+        sceneMgr.SendMessage(msg.get());
+    }
+    
+    // Hand the storage back so we don't reallocate every frame
+    delivering.clear();
+    if (pending.empty())
+    {
+        pending.swap(delivering);
+    }
+}
+
+void MessageQueue::ResetCoalescedCounts()
+{
+    for (auto& count : coalescedCounts)
+    {
+        count = 0;
+    }
+}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "BaseMessage.hpp"
+#include "MemoryTracker.hpp"
+
+namespace Core
+{
+class SceneManager;
+
+// Collects messages sent during a frame and delivers them in one pass.
+// Last-writer-wins messages are collapsed per (object, type) so only the most
+// recent one is dispatched, the rest are counted as coalesced.
+class MessageQueue
+{
+public:
+    MessageQueue();
+    
+    // Copies the message into the queue. Returns false if the message can't be
+    // queued (it isn't last-writer-wins or doesn't implement Clone()), in
+    // which case the caller should send it directly.
+    bool Push(const BaseMessage& msg);
+    
+    // Delivers all pending messages through the scene manager, in the order
+    // they were first queued, and empties the queue.
+    void Flush(SceneManager& sceneMgr);
+    
+    size_t GetPendingCount() const { return pending.size(); }
+    
+    // Number of messages of this type that were dropped because a later
+    // message replaced them before delivery.
+    uint64_t GetCoalescedCount(MessageType type) const { return coalescedCounts[static_cast<size_t>(type)]; }
+    void ResetCoalescedCounts();
+    
+private:
+    typedef std::vector<std::unique_ptr<BaseMessage>, TrackingAllocator<std::unique_ptr<BaseMessage>, MemoryCategory::Messages>> MessageList;
+    
+    static uint64_t MakeKey(int objectID, MessageType type)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(objectID)) << 32) | static_cast<uint32_t>(type);
+    }
+    
+private:
+    // Maps (object, type) to the slot in 'pending' that holds its latest message
+    std::unordered_map<uint64_t, size_t, std::hash<uint64_t>, std::equal_to<uint64_t>,
+        TrackingAllocator<std::pair<const uint64_t, size_t>, MemoryCategory::Messages>> slotByKey;
+    MessageList pending;
+    uint64_t coalescedCounts[static_cast<size_t>(MessageType::Count)];
+};
+}
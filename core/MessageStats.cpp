@@ -0,0 +1,123 @@
+#include "MessageStats.hpp"
+
+namespace Core
+{
+void LatencyHistogram::Reset()
+{
+    for (auto& count : counts)
+    {
+        count = 0;
+    }
+    
+    totalCount = 0;
+    maxValue = 0;
+}
+
+int LatencyHistogram::BucketIndex(uint64_t value)
+{
+    if (value < LinearLimit)
+    {
+        return static_cast<int>(value);
+    }
+    
+    // Position of the highest set bit, then the next few bits pick the sub-bucket
+    int exponent = 63 - __builtin_clzll(value);
+    int subBucket = static_cast<int>((value >> (exponent - SubBucketBits)) & (SubBucketCount - 1));
+    return LinearLimit + (exponent - (SubBucketBits + 1)) * SubBucketCount + subBucket;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(int index)
+{
+    if (index < LinearLimit)
+    {
+        return static_cast<uint64_t>(index);
+    }
+    
+    int exponent = (index - LinearLimit) / SubBucketCount + (SubBucketBits + 1);
+    int subBucket = (index - LinearLimit) % SubBucketCount;
+    uint64_t width = 1ull << (exponent - SubBucketBits);
+    return (1ull << exponent) + (subBucket + 1) * width - 1;
+}
+
+uint64_t LatencyHistogram::GetValueAtPercentile(double percentile) const
+{
+    if (totalCount == 0)
+    {
+        return 0;
+    }
+    
+    uint64_t target = static_cast<uint64_t>(percentile / 100.0 * totalCount + 0.5);
+    if (target < 1)
+    {
+        target = 1;
+    }
+    
+    uint64_t seen = 0;
+    for (int i = 0; i < BucketCount; ++i)
+    {
+        seen += counts[i];
+        if (seen >= target)
+        {
+            uint64_t bound = BucketUpperBound(i);
+            return bound < maxValue ? bound : maxValue;
+        }
+    }
+    
+    return maxValue;
+}
+
+MessageStats::Snapshot MessageStats::TakeSnapshot() const
+{
+    Snapshot snapshot;
+    for (size_t i = 0; i < static_cast<size_t>(MessageType::Count); ++i)
+    {
+        snapshot.types[i] = types[i];
+    }
+    
+    return snapshot;
+}
+
+void MessageStats::Reset()
+{
+    for (auto& stats : types)
+    {
+        stats = MessageTypeStats();
+    }
+}
+
+const char* MessageStats::GetTypeName(MessageType type)
+{
+    switch (type)
+    {
+        case MessageType::AddComponent: return "AddComponent";
+        case MessageType::GetPosition: return "GetPosition";
+        case MessageType::SetPosition: return "SetPosition";
+        case MessageType::GetRotation: return "GetRotation";
+        case MessageType::SetRotation: return "SetRotation";
+        case MessageType::SetVelocity: return "SetVelocity";
+        case MessageType::SetAngularVelocity: return "SetAngularVelocity";
+        default: break;
+    }
+    
+    return "Unknown";
+}
+
+void MessageStats::Snapshot::WriteCSV(std::ostream& out) const
+{
+    out << "type,sent,handled,unhandled,not_found,p50_ns,p90_ns,p99_ns,max_ns" << std::endl;
+    
+    for (size_t i = 0; i < static_cast<size_t>(MessageType::Count); ++i)
+    {
+        const MessageTypeStats& stats = types[i];
+        out << GetTypeName(static_cast<MessageType>(i)) << ","
+            << stats.sent << ","
+            << stats.handled << ","
+            << stats.unhandled << ","
+            << stats.notFound << ","
+            << stats.latency.GetValueAtPercentile(50.0) << ","
+            << stats.latency.GetValueAtPercentile(90.0) << ","
+            << stats.latency.GetValueAtPercentile(99.0) << ","
+            << stats.latency.GetMax() << std::endl;
+    }
+}
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include "BaseMessage.hpp"
+
+namespace Core
+{
+// Log-linear latency histogram in the style of HdrHistogram. Values below 16ns
+// get their own bucket, above that each power of two is split into 8 linear
+// sub-buckets, so any recorded value is off by at most 12.5%.
+class LatencyHistogram
+{
+public:
+    static const int SubBucketBits = 3;
+    static const int SubBucketCount = 1 << SubBucketBits;
+    static const int LinearLimit = SubBucketCount * 2;
+    static const int BucketCount = LinearLimit + (64 - (SubBucketBits + 1)) * SubBucketCount;
+    
+    LatencyHistogram() { Reset(); }
+    
+    void Record(uint64_t nanoseconds)
+    {
+        ++counts[BucketIndex(nanoseconds)];
+        ++totalCount;
+        if (nanoseconds > maxValue)
+        {
+            maxValue = nanoseconds;
+        }
+    }
+    
+    void Reset();
+    
+    uint64_t GetTotalCount() const { return totalCount; }
+    uint64_t GetMax() const { return maxValue; }
+    
+    // Returns the upper bound of the bucket holding the given percentile (0-100)
+    uint64_t GetValueAtPercentile(double percentile) const;
+    
+    static int BucketIndex(uint64_t value);
+    static uint64_t BucketUpperBound(int index);
+    
+private:
+    uint64_t counts[BucketCount];
+    uint64_t totalCount;
+    uint64_t maxValue;
+};
+
+struct MessageTypeStats
+{
+    uint64_t sent = 0;
+    uint64_t handled = 0;       // Object or one of its components handled it
+    uint64_t unhandled = 0;     // Object was found but nothing handled it
+    uint64_t notFound = 0;      // No object with the target ID exists
+    LatencyHistogram latency;
+};
+
+// Per-MessageType counters for everything that goes through
+// SceneManager::SendMessage. Recording is compiled out in SHIPPING_BUILD, the
+// same as PerfTimer, so the stats will just read as zero there.
+class MessageStats
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+    
+    enum class Result
+    {
+        Handled,
+        Unhandled,
+        NotFound,
+    };
+    
+    // Copy of every type's stats at the time it was taken
+    struct Snapshot
+    {
+        MessageTypeStats types[static_cast<size_t>(MessageType::Count)];
+        
+        const MessageTypeStats& Get(MessageType type) const { return types[static_cast<size_t>(type)]; }
+        
+        // One row per message type: counts followed by latency percentiles in nanoseconds
+        void WriteCSV(std::ostream& out) const;
+    };
+    
+    void Record(MessageType type, Result result, Clock::time_point start)
+    {
+        uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        
+        MessageTypeStats& stats = types[static_cast<size_t>(type)];
+        ++stats.sent;
+        switch (result)
+        {
+            case Result::Handled: ++stats.handled; break;
+            case Result::Unhandled: ++stats.unhandled; break;
+            case Result::NotFound: ++stats.notFound; break;
+        }
+        stats.latency.Record(elapsed);
+    }
+    
+    const MessageTypeStats& Get(MessageType type) const { return types[static_cast<size_t>(type)]; }
+    Snapshot TakeSnapshot() const;
+    void Reset();
+    
+    static const char* GetTypeName(MessageType type);
+    
+private:
+    MessageTypeStats types[static_cast<size_t>(MessageType::Count)];
+};
+}
@@ -7,17 +7,29 @@
 namespace Core
 {
     void Object::AddComponent(Component* component)
+    {
+        if (HasComponent(component->GetComponentType()))
+        {
+            throw "Component of type already exists.";
+        }
+        
+        // The component itself is counted by its operator new, this counts the control block
+        AddComponent(std::shared_ptr<Component>(component, std::default_delete<Component>(),
+                                                TrackingAllocator<Component, MemoryCategory::Components>()));
+    }
+    
+    void Object::AddComponent(std::shared_ptr<Component> component)
     {
         auto componentType = component->GetComponentType();
         
-        if (componentLookup.find(componentType) != componentLookup.end())
+        if (HasComponent(componentType))
         {
             throw "Component of type already exists.";
         }
         
-        auto componentPtr = std::shared_ptr<Component>(component);
-        componentLookup[componentType] = componentPtr;
-        components.push_back(componentPtr);
+        componentTypes.push_back(componentType);
+        componentMask |= ComponentBit(componentType);
+        components.push_back(component);
     }
     
     bool Object::SendMessage(BaseMessage* msg)
@@ -30,14 +42,13 @@ namespace Core
             default:
                 // Check if components handle the message
                 // TODO: This could be optimized by keeping a mapping of which components care about which messages
-                for (auto c : components)
+                bool handled = false;
+                for (auto& c : components)
                 {
-                    c->SendMessage(msg);
+                    handled |= c->SendMessage(msg);
                 }
-                break;
+                return handled;
         }
-        
-        return false;
     }
     
     void Object::MsgHandlerAddComponent(AddComponentMessage* msg)
@@ -2,18 +2,21 @@
 
 #include <memory>
 #include <vector>
-#include <map>
 #include "Component.hpp"
+#include "MemoryTracker.hpp"
 
 class AddComponentMessage;
 
 namespace Core
 {
 class BaseMessage;
+template <typename T> class BlockStorage;
     
 class Object
 {
 public:
+    typedef std::vector<std::shared_ptr<Component>, TrackingAllocator<std::shared_ptr<Component>, MemoryCategory::Objects>> ComponentList;
+    
     Object(int uniqueID) : id(uniqueID)
     {
     }
@@ -21,7 +24,38 @@ public:
     int GetID() const { return id; }
     
     void AddComponent(Component* component);
-    bool HasComponent(ComponentType type) const { return componentLookup.find(type) != componentLookup.end(); }
+    void AddComponent(std::shared_ptr<Component> component);
+    bool HasComponent(ComponentType type) const { return (componentMask & ComponentBit(type)) != 0; }
+    
+    // Returns nullptr if the object has no component of this type
+    Component* GetComponent(ComponentType type) const
+    {
+        for (size_t i = 0; i < componentTypes.size(); ++i)
+        {
+            if (componentTypes[i] == type)
+            {
+                return components[i].get();
+            }
+        }
+        
+        return nullptr;
+    }
+    
+    const ComponentList& GetComponents() const { return components; }
+    
+    // One bit per ComponentType the object has, and per tag it carries.
+    // Tags are changed through the SceneManager so its queries stay current.
+    uint64_t GetComponentMask() const { return componentMask; }
+    uint64_t GetTagMask() const { return tagMask; }
+    bool HasTag(uint32_t tag) const { return (tagMask & (uint64_t(1) << tag)) != 0; }
+    
+    // Heap memory held by the object itself, not counting its components
+    size_t GetHeapBytes() const
+    {
+        return components.capacity() * sizeof(components[0]) + componentTypes.capacity() * sizeof(componentTypes[0]);
+    }
+    
+    friend class SceneManager;
     
     bool SendMessage(BaseMessage* msg);
 
@@ -30,7 +64,20 @@ private:
     
 private:
     int id;
-    std::vector<std::shared_ptr<Component>> components;
-    std::map<ComponentType, std::shared_ptr<Component>> componentLookup;
+    ComponentList components;
+    
+    // Parallel to components. Objects have a handful of components at most,
+    // so a linear scan of this beats any map.
+    std::vector<ComponentType, TrackingAllocator<ComponentType, MemoryCategory::Objects>> componentTypes;
+    
+    uint64_t componentMask = 0;
+    uint64_t tagMask = 0;
+    
+    // Where the owning scene keeps the object in its list
+    size_t sceneIndex = 0;
+    
+    // The batch the object was built in, if any. The scene destroys it there
+    // when it's removed, since the batch outlives it.
+    BlockStorage<Object>* block = nullptr;
 };
 }
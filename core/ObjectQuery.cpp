@@ -0,0 +1,45 @@
+#include "ObjectQuery.hpp"
+#include "Object.hpp"
+
+namespace Core
+{
+void ObjectQuery::Update(const Object* object, uint64_t oldComponents, uint64_t oldTags, bool isNew)
+{
+    bool matched = !isNew && filter.Matches(oldComponents, oldTags);
+    bool matches = filter.Matches(object->GetComponentMask(), object->GetTagMask());
+    
+    if (matches && !matched)
+    {
+        indexByObject[object->GetID()] = objectIDs.size();
+        objectIDs.push_back(object->GetID());
+        objects.push_back(object);
+    }
+    else if (matched && !matches)
+    {
+        Remove(object->GetID());
+    }
+}
+
+void ObjectQuery::Remove(int objectID)
+{
+    auto it = indexByObject.find(objectID);
+    if (it == indexByObject.end())
+    {
+        return;
+    }
+    
+    // Swap the last match into the hole
+    size_t index = it->second;
+    size_t last = objectIDs.size() - 1;
+    indexByObject.erase(it);
+    if (index != last)
+    {
+        objectIDs[index] = objectIDs[last];
+        objects[index] = objects[last];
+        indexByObject[objectIDs[index]] = index;
+    }
+    
+    objectIDs.pop_back();
+    objects.pop_back();
+}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "Component.hpp"
+
+namespace Core
+{
+class Object;
+
+// Index of a tag name within its scene, see SceneManager::GetTag()
+typedef uint32_t ObjectTag;
+
+// Which objects a query selects: every listed component, every required tag
+// and none of the excluded tags.
+//
+//     QueryFilter().With(ComponentType::Transform).WithTag(enemy).WithoutTag(dead)
+struct QueryFilter
+{
+    uint64_t requiredComponents = 0;
+    uint64_t requiredTags = 0;
+    uint64_t excludedTags = 0;
+    
+    QueryFilter& With(ComponentType type) { requiredComponents |= ComponentBit(type); return *this; }
+    QueryFilter& WithTag(ObjectTag tag) { requiredTags |= uint64_t(1) << tag; return *this; }
+    QueryFilter& WithoutTag(ObjectTag tag) { excludedTags |= uint64_t(1) << tag; return *this; }
+    
+    bool Matches(uint64_t componentMask, uint64_t tagMask) const
+    {
+        return (componentMask & requiredComponents) == requiredComponents
+            && (tagMask & requiredTags) == requiredTags
+            && (tagMask & excludedTags) == 0;
+    }
+    
+    bool operator==(const QueryFilter& rhs) const
+    {
+        return requiredComponents == rhs.requiredComponents && requiredTags == rhs.requiredTags && excludedTags == rhs.excludedTags;
+    }
+};
+
+// The set of objects matching a filter, kept up to date by the scene as
+// components and tags change, so going over it costs only the number of
+// matches. Order is arbitrary and changes as objects leave.
+class ObjectQuery
+{
+public:
+    explicit ObjectQuery(const QueryFilter& filter) : filter(filter) {}
+    
+    const QueryFilter& GetFilter() const { return filter; }
+    
+    size_t GetCount() const { return objectIDs.size(); }
+    std::span<const int> GetObjectIDs() const { return objectIDs; }
+    std::span<const Object* const> GetObjects() const { return objects; }
+    
+    // Called by the scene when an object's masks change. New objects weren't
+    // in the query whatever their old masks say.
+    void Update(const Object* object, uint64_t oldComponents, uint64_t oldTags, bool isNew);
+    void Remove(int objectID);
+    
+private:
+    QueryFilter filter;
+    std::vector<int> objectIDs;
+    std::vector<const Object*> objects;
+    std::unordered_map<int, size_t> indexByObject;
+};
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BlockStorage.hpp"
+#include "Component.hpp"
+
+namespace Core
+{
+// Describes a shape of object: which components it has and their default
+// values. Each component is constructed once, when it's added to the prefab,
+// and instances are copied from that default. Copies share everything the
+// component type shares (such as its message handler table) copy-on-write,
+// so instantiating doesn't allocate per component beyond the batch block.
+//
+//     Prefab prefab("Crate");
+//     prefab.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+//     sceneMgr.CreateObjects(50000, prefab);
+class Prefab
+{
+public:
+    // Builds 'count' components into 'out', one per new object
+    typedef std::function<void(size_t count, std::vector<std::shared_ptr<Component>>& out)> ComponentFactory;
+    
+    explicit Prefab(const std::string& name = std::string()) : name(name) {}
+    
+    const std::string& GetName() const { return name; }
+    
+    // Returns the default instance so it can be tweaked before instantiating.
+    // Changes only affect objects created afterwards.
+    template <typename T, typename... Args>
+    T& AddComponent(Args&&... args)
+    {
+        std::shared_ptr<T> defaults = std::allocate_shared<T>(TrackingAllocator<T, MemoryCategory::Components>(), std::forward<Args>(args)...);
+        componentFactories.push_back([defaults](size_t count, std::vector<std::shared_ptr<Component>>& out)
+        {
+            auto block = std::allocate_shared<BlockStorage<T>>(TrackingAllocator<BlockStorage<T>, MemoryCategory::Components>(),
+                                                               count, MemoryCategory::Components);
+            for (size_t i = 0; i < count; ++i)
+            {
+                out.push_back(std::shared_ptr<Component>(block, block->Emplace(*defaults)));
+            }
+        });
+        
+        return *defaults;
+    }
+    
+    const std::vector<ComponentFactory>& GetComponentFactories() const { return componentFactories; }
+    
+private:
+    std::string name;
+    std::vector<ComponentFactory> componentFactories;
+};
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace Core
+{
+// Future-like handle for the answer to a query such as an object's position.
+// The answer lives in shared state rather than on a caller-owned message, so
+// it can be filled in later (after a batched flush) and read from any thread
+// once IsReady() returns true.
+template <typename T>
+class QueryResult
+{
+public:
+    QueryResult() : state(std::make_shared<State>()) {}
+    
+    bool IsReady() const { return state->status.load(std::memory_order_acquire) != Pending; }
+    
+    // False when the target object doesn't exist or lacks the component that
+    // answers the query. Only meaningful once IsReady() is true.
+    bool WasFound() const { return state->status.load(std::memory_order_acquire) == Fulfilled; }
+    
+    const T& Get() const
+    {
+        if (!WasFound())
+        {
+            throw "Query result is not available.";
+        }
+        
+        return state->value;
+    }
+    
+    void Fulfill(const T& value)
+    {
+        state->value = value;
+        state->status.store(Fulfilled, std::memory_order_release);
+    }
+    
+    void Fail() { state->status.store(NotFound, std::memory_order_release); }
+    
+private:
+    enum Status
+    {
+        Pending = 0,
+        Fulfilled,
+        NotFound,
+    };
+    
+    struct State
+    {
+        std::atomic<int> status{Pending};
+        T value;
+    };
+    
+    std::shared_ptr<State> state;
+};
+}
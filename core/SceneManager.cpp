@@ -1,6 +1,15 @@
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <unordered_set>
 #include "SceneManager.hpp"
 #include "BaseMessage.hpp"
+#include "ComponentRegistry.hpp"
+#include "MessageLog.hpp"
+#include "../components/AngularVelocityComponent.hpp"
+#include "../components/TransformComponent.hpp"
+#include "../components/VelocityComponent.hpp"
+#include "../messages/AddComponentMessage.hpp"
 
 namespace Core
 {
@@ -9,22 +18,184 @@ int SceneManager::s_nextObjectID = 0;
 SceneManager::~SceneManager()
 {
     std::cout << objects.size() << " Objects were still alive and are being destroyed as SceneManager is destroyed." << std::endl;
+    
+    // Components can outlive the scene if someone else holds on to them
+    transformStorage.Clear();
 }
 
 const Object& SceneManager::CreateObject()
 {
-    std::shared_ptr<Object> newObj = std::make_shared<Object>(s_nextObjectID++);
+    std::shared_ptr<Object> newObj = std::allocate_shared<Object>(TrackingAllocator<Object, MemoryCategory::Objects>(), s_nextObjectID++);
 
     // Add to the vector
+    newObj->sceneIndex = objects.size();
     objects.push_back(newObj);
     
     // Add to the map that allows fast lookup by ID
     objectsByID[newObj->GetID()] = newObj;
+    
+    UpdateQueries(*newObj, 0, 0, true);
 
     return *newObj;
 }
 
-const Object& SceneManager::FindObjectByID(int id)
+int SceneManager::CreateObjects(size_t count, const Prefab& prefab)
+{
+    return CreateObjects(count, prefab, ObjectInitializer());
+}
+
+int SceneManager::CreateObjects(size_t count, const Prefab& prefab, const ObjectInitializer& initialize)
+{
+    int firstID = s_nextObjectID;
+    if (count == 0)
+    {
+        return firstID;
+    }
+    
+    auto objectBlock = std::allocate_shared<BlockStorage<Object>>(TrackingAllocator<BlockStorage<Object>, MemoryCategory::Objects>(),
+                                                                  count, MemoryCategory::Objects);
+    
+    // Keep growth geometric, small batches (such as streamed cells arriving a
+    // piece at a time) would otherwise copy the whole list every time
+    if (objects.size() + count > objects.capacity())
+    {
+        objects.reserve(std::max(objects.size() + count, objects.capacity() * 2));
+    }
+    
+    // Build every component for the batch up front, one factory (and one
+    // allocation) per component type.
+    const auto& factories = prefab.GetComponentFactories();
+    std::vector<std::vector<std::shared_ptr<Component>>> componentsByType(factories.size());
+    for (size_t i = 0; i < factories.size(); ++i)
+    {
+        componentsByType[i].reserve(count);
+        factories[i](count, componentsByType[i]);
+    }
+    
+    for (size_t i = 0; i < count; ++i)
+    {
+        Object* object = objectBlock->Emplace(s_nextObjectID++);
+        std::shared_ptr<Object> newObj(objectBlock, object);
+        object->block = objectBlock.get();
+        
+        for (auto& components : componentsByType)
+        {
+            newObj->AddComponent(std::move(components[i]));
+        }
+        
+        if (initialize)
+        {
+            initialize(i, *newObj);
+        }
+        
+        for (const auto& component : newObj->GetComponents())
+        {
+            IndexComponent(*newObj, component.get());
+        }
+        
+        newObj->sceneIndex = objects.size();
+        objects.push_back(newObj);
+        UpdateQueries(*newObj, 0, 0, true);
+        
+        // IDs only ever increase, so every insert belongs at the end of the map
+        objectsByID.emplace_hint(objectsByID.end(), newObj->GetID(), newObj);
+    }
+    
+    return firstID;
+}
+
+bool SceneManager::DestroyObject(int id)
+{
+    return DestroyObjects(std::span<const int>(&id, 1)) == 1;
+}
+
+size_t SceneManager::DestroyObjects(std::span<const int> ids)
+{
+    std::vector<int> sortedIDs(ids.begin(), ids.end());
+    std::sort(sortedIDs.begin(), sortedIDs.end());
+    sortedIDs.erase(std::unique(sortedIDs.begin(), sortedIDs.end()), sortedIDs.end());
+    
+    // Everything below is found through the objects themselves, so the cost
+    // depends on how many are destroyed and not on the size of the scene
+    std::vector<size_t> objectIndices;
+    std::vector<size_t> transformSlots;
+    objectIndices.reserve(sortedIDs.size());
+    transformSlots.reserve(sortedIDs.size());
+    
+    size_t kept = 0;
+    for (int id : sortedIDs)
+    {
+        auto it = objectsByID.find(id);
+        if (it == objectsByID.end())
+        {
+            continue;
+        }
+        
+        const Object& object = *it->second;
+        objectIndices.push_back(object.sceneIndex);
+        
+        TransformComponent* transform = static_cast<TransformComponent*>(object.GetComponent(ComponentType::Transform));
+        if (transform != nullptr && transform->IsInStorage(transformStorage))
+        {
+            transformSlots.push_back(transform->GetStorageIndex());
+        }
+        
+        objectsByID.erase(it);
+        sortedIDs[kept++] = id;
+    }
+    sortedIDs.resize(kept);
+    
+    if (objectIndices.empty())
+    {
+        return 0;
+    }
+    
+    // Hand data back to the components while they're certainly still alive
+    transformStorage.RemoveSlots(transformSlots);
+    eventBus.RemoveObjects(sortedIDs);
+    
+    for (auto& query : queries)
+    {
+        for (int id : sortedIDs)
+        {
+            query->Remove(id);
+        }
+    }
+    
+    // Tasks waiting on a message to a destroyed object would never wake
+    for (int id : sortedIDs)
+    {
+        taskScheduler.FailMessageWaiters(id);
+    }
+    
+    ++componentVersion;
+    
+    // Swap the last object into each hole, highest index first so the last
+    // object is never one that's also going
+    std::sort(objectIndices.begin(), objectIndices.end(), std::greater<size_t>());
+    for (size_t index : objectIndices)
+    {
+        std::shared_ptr<Object> removed = std::move(objects[index]);
+        if (index != objects.size() - 1)
+        {
+            objects[index] = std::move(objects.back());
+            objects[index]->sceneIndex = index;
+        }
+        objects.pop_back();
+        
+        // Batched objects share their block's lifetime, so they have to be
+        // destroyed by hand for their components to be released. 'removed'
+        // keeps the block alive until it's done.
+        if (removed->block != nullptr)
+        {
+            removed->block->Destroy(removed.get());
+        }
+    }
+    
+    return objectIndices.size();
+}
+
+const Object& SceneManager::FindObjectByID(int id) const
 {
     auto it = objectsByID.find(id);
     if (it != objectsByID.end())
@@ -37,16 +208,393 @@ const Object& SceneManager::FindObjectByID(int id)
 
 // Returns true if the object or any components handled the message
 bool SceneManager::SendMessage(BaseMessage* msg)
+{
+    if (messageRecorder != nullptr)
+    {
+        messageRecorder->Record(*msg);
+    }
+    
+#ifndef SHIPPING_BUILD
+    MessageStats::Clock::time_point start = MessageStats::Clock::now();
+    MessageStats::Result result = DeliverMessage(msg);
+    messageStats.Record(msg->GetType(), result, start);
+#else
+    MessageStats::Result result = DeliverMessage(msg);
+#endif
+    
+    if (result != MessageStats::Result::NotFound)
+    {
+        taskScheduler.NotifyMessage(msg->GetTargetObjectID(), msg->GetType());
+    }
+    
+    return result == MessageStats::Result::Handled;
+}
+
+MessageStats::Result SceneManager::DeliverMessage(BaseMessage* msg)
 {
     // We look for the object in the scene by its ID
     auto objIt = objectsByID.find(msg->GetTargetObjectID());
     if (objIt != objectsByID.end())
     {
         // Object was found, so send it the message
-        return objIt->second->SendMessage(msg);
+        bool handled = objIt->second->SendMessage(msg);
+        if (handled && msg->GetType() == MessageType::AddComponent)
+        {
+            const Object& object = *objIt->second;
+            Component* component = static_cast<AddComponentMessage*>(msg)->GetComponent();
+            IndexComponent(object, component);
+            UpdateQueries(object, object.GetComponentMask() & ~ComponentBit(component->GetComponentType()), object.GetTagMask(), false);
+        }
+        
+        return handled ? MessageStats::Result::Handled : MessageStats::Result::Unhandled;
     }
     
     // Object with the specified ID wasn't found
-    return false;
+    return MessageStats::Result::NotFound;
+}
+
+void SceneManager::QueueMessage(const BaseMessage& msg)
+{
+    if (!messageQueue.Push(msg))
+    {
+        // Not safe to defer, so deliver it now
+        SendMessage(const_cast<BaseMessage*>(&msg));
+    }
+}
+
+void SceneManager::FlushMessages()
+{
+    messageQueue.Flush(*this);
+}
+
+void SceneManager::PublishSnapshot(uint64_t step)
+{
+    WorldSnapshot& snapshot = snapshots.BeginWrite();
+    snapshot.step = step;
+    snapshot.transforms.Capture(*this);
+    snapshots.Publish();
+}
+
+Vector3 SceneManager::RebaseOrigin(const Vector3d& newOrigin, ThreadPool* threadPool)
+{
+    Vector3 offset = (worldOrigin - newOrigin).ToFloat();
+    worldOrigin -= Vector3d(offset);
+    transformStorage.Translate(offset, threadPool);
+    return offset;
+}
+
+MemoryUsageReport SceneManager::MemoryReport() const
+{
+    MemoryUsageReport report;
+    for (size_t i = 0; i < static_cast<size_t>(MemoryCategory::Count); ++i)
+    {
+        report.categories[i] = MemoryTracker::GetUsage(static_cast<MemoryCategory>(i));
+    }
+    
+    // A map node is the pair plus roughly three links and a color
+    const size_t mapNodeBytes = sizeof(std::pair<const int, std::shared_ptr<Object>>) + 4 * sizeof(void*);
+    report.objectCount = objects.size();
+    report.objectBytes = objects.size() * sizeof(objects[0]) + objectsByID.size() * mapNodeBytes;
+    report.objectListSlackBytes = (objects.capacity() - objects.size()) * sizeof(objects[0]);
+    
+    size_t countsByType[MaxComponentTypes] = {};
+    std::unordered_set<const MessageHandlerTable*> handlerTables;
+    for (const auto& object : objects)
+    {
+        report.objectBytes += sizeof(Object) + object->GetHeapBytes();
+        
+        for (const auto& component : object->GetComponents())
+        {
+            ++countsByType[static_cast<size_t>(component->GetComponentType())];
+            
+            const MessageHandlerTable* table = component->GetMessageHandlerTable();
+            if (table != nullptr)
+            {
+                handlerTables.insert(table);
+            }
+            
+            if (component->HasOwnMessageHandlers())
+            {
+                ++report.componentsWithOwnHandlers;
+            }
+        }
+    }
+    
+    const ComponentRegistry& registry = ComponentRegistry::Get();
+    for (size_t type = 0; type < MaxComponentTypes; ++type)
+    {
+        if (countsByType[type] == 0)
+        {
+            continue;
+        }
+        
+        const ComponentTypeInfo* info = registry.Find(static_cast<ComponentType>(type));
+        std::string name = info != nullptr ? info->name : "Type " + std::to_string(type);
+        size_t bytes = info != nullptr ? countsByType[type] * info->size : 0;
+        report.componentTypes.push_back(MemoryUsageReport::ComponentTypeUsage{ name, countsByType[type], bytes });
+    }
+    
+    // Handlers that don't fit std::function's inline buffer allocate on top of this
+    report.handlerTableCount = handlerTables.size();
+    report.handlerTableBytes = handlerTables.size() * sizeof(MessageHandlerTable);
+    
+    report.pendingMessages = messageQueue.GetPendingCount();
+    report.transformStorageBytes = transformStorage.GetMemoryUsage();
+    
+    return report;
+}
+
+void SceneManager::IndexComponent(const Object& object, Component* component)
+{
+    ++componentVersion;
+    
+    // Velocities share the transform's slot, so whichever of the two gets
+    // indexed second is what links them up. Attaching twice is harmless.
+    switch (component->GetComponentType())
+    {
+        case ComponentType::Transform:
+        {
+            size_t index = transformStorage.Add(object, static_cast<TransformComponent*>(component));
+            
+            if (Component* velocity = object.GetComponent(ComponentType::Velocity))
+            {
+                transformStorage.AttachVelocity(index, static_cast<VelocityComponent*>(velocity));
+            }
+            
+            if (Component* angularVelocity = object.GetComponent(ComponentType::AngularVelocity))
+            {
+                transformStorage.AttachAngularVelocity(index, static_cast<AngularVelocityComponent*>(angularVelocity));
+            }
+            break;
+        }
+        case ComponentType::Velocity:
+        {
+            TransformComponent* transform = static_cast<TransformComponent*>(object.GetComponent(ComponentType::Transform));
+            if (transform != nullptr && transform->IsInStorage(transformStorage))
+            {
+                transformStorage.AttachVelocity(transform->GetStorageIndex(), static_cast<VelocityComponent*>(component));
+            }
+            break;
+        }
+        case ComponentType::AngularVelocity:
+        {
+            TransformComponent* transform = static_cast<TransformComponent*>(object.GetComponent(ComponentType::Transform));
+            if (transform != nullptr && transform->IsInStorage(transformStorage))
+            {
+                transformStorage.AttachAngularVelocity(transform->GetStorageIndex(), static_cast<AngularVelocityComponent*>(component));
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+ObjectTag SceneManager::GetTag(const std::string& name)
+{
+    auto it = std::find(tagNames.begin(), tagNames.end(), name);
+    if (it != tagNames.end())
+    {
+        return static_cast<ObjectTag>(it - tagNames.begin());
+    }
+    
+    if (tagNames.size() == 64)
+    {
+        throw "Too many tags";
+    }
+    
+    tagNames.push_back(name);
+    return static_cast<ObjectTag>(tagNames.size() - 1);
+}
+
+bool SceneManager::AddTag(int objectID, ObjectTag tag)
+{
+    auto it = objectsByID.find(objectID);
+    if (it == objectsByID.end() || it->second->HasTag(tag))
+    {
+        return false;
+    }
+    
+    Object& object = *it->second;
+    uint64_t oldTags = object.tagMask;
+    object.tagMask |= uint64_t(1) << tag;
+    UpdateQueries(object, object.componentMask, oldTags, false);
+    return true;
+}
+
+bool SceneManager::RemoveTag(int objectID, ObjectTag tag)
+{
+    auto it = objectsByID.find(objectID);
+    if (it == objectsByID.end() || !it->second->HasTag(tag))
+    {
+        return false;
+    }
+    
+    Object& object = *it->second;
+    uint64_t oldTags = object.tagMask;
+    object.tagMask &= ~(uint64_t(1) << tag);
+    UpdateQueries(object, object.componentMask, oldTags, false);
+    return true;
+}
+
+std::shared_ptr<const ObjectQuery> SceneManager::GetQuery(const QueryFilter& filter)
+{
+    for (const auto& query : queries)
+    {
+        if (query->GetFilter() == filter)
+        {
+            return query;
+        }
+    }
+    
+    // Only a new query pays for a pass over every object
+    auto query = std::make_shared<ObjectQuery>(filter);
+    for (const auto& object : objects)
+    {
+        query->Update(object.get(), 0, 0, true);
+    }
+    
+    queries.push_back(query);
+    return query;
+}
+
+void SceneManager::UpdateQueries(const Object& object, uint64_t oldComponents, uint64_t oldTags, bool isNew)
+{
+    for (auto& query : queries)
+    {
+        query->Update(&object, oldComponents, oldTags, isNew);
+    }
+}
+
+const Object* SceneManager::FindObject(int id) const
+{
+    auto it = objectsByID.find(id);
+    return it != objectsByID.end() ? it->second.get() : nullptr;
+}
+
+static const TransformComponent* GetTransform(const Object* object)
+{
+    if (object == nullptr)
+    {
+        return nullptr;
+    }
+    
+    return static_cast<const TransformComponent*>(object->GetComponent(ComponentType::Transform));
+}
+
+bool SceneManager::FindTransformSlot(int objectID, size_t& slot) const
+{
+    const TransformComponent* transform = GetTransform(FindObject(objectID));
+    if (transform == nullptr || !transform->IsInStorage(transformStorage))
+    {
+        return false;
+    }
+    
+    slot = transform->GetStorageIndex();
+    return true;
+}
+
+QueryResult<Vector3> SceneManager::QueryPosition(int objectID) const
+{
+    QueryResult<Vector3> result;
+    const TransformComponent* transform = GetTransform(FindObject(objectID));
+    if (transform != nullptr)
+    {
+        result.Fulfill(transform->GetPosition());
+    }
+    else
+    {
+        result.Fail();
+    }
+    
+    return result;
+}
+
+QueryResult<Quaternion> SceneManager::QueryRotation(int objectID) const
+{
+    QueryResult<Quaternion> result;
+    const TransformComponent* transform = GetTransform(FindObject(objectID));
+    if (transform != nullptr)
+    {
+        result.Fulfill(transform->GetRotation());
+    }
+    else
+    {
+        result.Fail();
+    }
+    
+    return result;
+}
+
+QueryResult<Vector3> SceneManager::QueuePositionQuery(int objectID)
+{
+    PendingQuery<Vector3> query = { objectID, QueryResult<Vector3>() };
+    pendingPositionQueries.push_back(query);
+    return query.result;
+}
+
+QueryResult<Quaternion> SceneManager::QueueRotationQuery(int objectID)
+{
+    PendingQuery<Quaternion> query = { objectID, QueryResult<Quaternion>() };
+    pendingRotationQueries.push_back(query);
+    return query.result;
+}
+
+void SceneManager::FlushQueries()
+{
+    FlushPendingQueries(pendingPositionQueries, [](const TransformComponent& t) { return t.GetPosition(); });
+    FlushPendingQueries(pendingRotationQueries, [](const TransformComponent& t) { return t.GetRotation(); });
+}
+
+template <typename T, typename Answer>
+void SceneManager::FlushPendingQueries(std::vector<PendingQuery<T>>& queries, Answer answer)
+{
+    // Sorting by ID groups repeat queries for an object onto one lookup and
+    // keeps the tree walk moving forwards. Each new ID is still a lower_bound
+    // rather than a walk from the last one, so a few queries into a big scene
+    // don't pay for every object in between.
+    std::stable_sort(queries.begin(), queries.end(), [](const PendingQuery<T>& a, const PendingQuery<T>& b)
+    {
+        return a.objectID < b.objectID;
+    });
+    
+    auto objIt = objectsByID.end();
+    int lookedUpID = 0;
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        PendingQuery<T>& query = queries[i];
+        if (i == 0 || query.objectID != lookedUpID)
+        {
+            // The next object in the map is the common case for dense IDs
+            if (objIt != objectsByID.end() && objIt->first < query.objectID)
+            {
+                ++objIt;
+            }
+            
+            if (objIt == objectsByID.end() || objIt->first != query.objectID)
+            {
+                objIt = objectsByID.lower_bound(query.objectID);
+            }
+            
+            lookedUpID = query.objectID;
+        }
+        
+        const TransformComponent* transform = nullptr;
+        if (objIt != objectsByID.end() && objIt->first == query.objectID)
+        {
+            transform = GetTransform(objIt->second.get());
+        }
+        
+        if (transform != nullptr)
+        {
+            query.result.Fulfill(answer(*transform));
+        }
+        else
+        {
+            query.result.Fail();
+        }
+    }
+    
+    queries.clear();
 }
 }
@@ -1,12 +1,30 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <map>
+#include <span>
+#include <string>
+#include "EventBus.hpp"
+#include "MemoryTracker.hpp"
 #include "Object.hpp"
+#include "ObjectQuery.hpp"
+#include "Prefab.hpp"
+#include "MessageQueue.hpp"
+#include "MessageStats.hpp"
+#include "QueryResult.hpp"
+#include "SnapshotPublisher.hpp"
+#include "TaskScheduler.hpp"
+#include "TransformStorage.hpp"
+#include "../math/Quaternion.hpp"
+#include "../math/Vector3.hpp"
+#include "../math/Vector3d.hpp"
 
 namespace Core
 {
 class BaseMessage;
+class MessageRecorder;
+class ThreadPool;
     
 class SceneManager
 {
@@ -14,14 +32,169 @@ public:
     ~SceneManager();
     
     bool SendMessage(BaseMessage* msg);
+    
+    // Defers delivery until FlushMessages(). Last-writer-wins messages to the
+    // same object are collapsed, anything else is sent immediately.
+    void QueueMessage(const BaseMessage& msg);
+    void FlushMessages();
+    
+    const MessageQueue& GetMessageQueue() const { return messageQueue; }
+    
+    // Every message sent from now on is also written to the recorder, which
+    // has to outlive the scene or be detached with nullptr first.
+    void SetMessageRecorder(MessageRecorder* recorder) { messageRecorder = recorder; }
+    MessageRecorder* GetMessageRecorder() const { return messageRecorder; }
+    
+    // Events for any number of subscribers, delivered by FlushEvents().
+    // Destroyed objects are unsubscribed automatically.
+    EventBus& GetEventBus() { return eventBus; }
+    void FlushEvents() { eventBus.Flush(*this); }
+    
+    // Per-type send counts and latencies. Always zero in SHIPPING_BUILD.
+    const MessageStats& GetMessageStats() const { return messageStats; }
+    MessageStats::Snapshot TakeMessageStatsSnapshot() const { return messageStats.TakeSnapshot(); }
+    void ResetMessageStats() { messageStats.Reset(); }
+    
+    // Transform queries. The Query* versions are answered before returning,
+    // the Queue* versions are answered together by the next FlushQueries()
+    // in a single ordered pass over the scene instead of one dispatch each.
+    QueryResult<Vector3> QueryPosition(int objectID) const;
+    QueryResult<Quaternion> QueryRotation(int objectID) const;
+    QueryResult<Vector3> QueuePositionQuery(int objectID);
+    QueryResult<Quaternion> QueueRotationQuery(int objectID);
+    void FlushQueries();
+    
+    // Scripted tasks are owned by the scene and resumed from UpdateTasks()
+    void StartTask(Task task) { taskScheduler.Start(std::move(task)); }
+    void UpdateTasks(float deltaSeconds) { taskScheduler.Update(deltaSeconds); }
+    size_t GetTaskCount() const { return taskScheduler.GetTaskCount(); }
      
     const Object& CreateObject();
     
-    const Object& FindObjectByID(int it);
+    // Creates 'count' objects with the prefab's components. Objects and
+    // components are each constructed in a single allocation per batch.
+    // The new objects get the consecutive IDs [returned ID, returned ID + count).
+    int CreateObjects(size_t count, const Prefab& prefab);
+    
+    // As above, calling 'initialize' with each new object's index in the
+    // batch once its components are attached but before the scene indexes
+    // them. Values set on the components then are what the scene's storage
+    // starts with, without sending any messages.
+    typedef std::function<void(size_t index, const Object& object)> ObjectInitializer;
+    int CreateObjects(size_t count, const Prefab& prefab, const ObjectInitializer& initialize);
+    
+    // Returns false if no object has this ID
+    bool DestroyObject(int id);
+    
+    // Removes all of the given objects at a cost that grows with how many
+    // there are, not with the size of the scene. Survivors are moved into
+    // the holes, so object and transform order isn't kept. IDs that don't
+    // exist are ignored. Returns how many were destroyed.
+    size_t DestroyObjects(std::span<const int> ids);
+    
+    size_t GetObjectCount() const { return objects.size(); }
+    
+    const Object& FindObjectByID(int it) const;
+    
+    // Tags are named per scene, the name is registered the first time it's
+    // asked for. A scene has room for 64 tag names.
+    ObjectTag GetTag(const std::string& name);
+    
+    // Both return false if there's no such object or nothing changed
+    bool AddTag(int objectID, ObjectTag tag);
+    bool RemoveTag(int objectID, ObjectTag tag);
+    
+    // The scene's query for this filter, created on first use. Queries are
+    // shared between callers asking for the same filter and are updated as
+    // objects are created, destroyed, gain components and change tags, for
+    // as long as the scene lives.
+    std::shared_ptr<const ObjectQuery> GetQuery(const QueryFilter& filter);
+    
+    // Position, rotation and velocity of every transform in the scene, packed
+    // densely alongside the ID of the owning object. The order only changes when
+    // transforms are added or removed, which also bumps the layout version, so
+    // systems can cache per-transform data by index.
+    const TransformStorage& GetTransformStorage() const { return transformStorage; }
+    TransformStorage& GetTransformStorage() { return transformStorage; }
+    uint64_t GetTransformLayoutVersion() const { return transformStorage.GetLayoutVersion(); }
+    
+    // The object's slot in the transform storage. Returns false if it has no
+    // transform in this scene.
+    bool FindTransformSlot(int objectID, size_t& slot) const;
+    
+    // Positions in the scene are floats relative to this world space origin.
+    // Moving the origin to wherever the action is (the player, the camera)
+    // keeps them small enough to stay precise in a world tens of kilometres
+    // across. Rebasing shifts every transform in one parallel pass, so do it
+    // between frames with no messages queued, since queued positions would
+    // still be relative to the old origin. Anything else that writes
+    // positions has to go through ToLocal() to keep up, as AnimationSystem
+    // does for its clips, which are world space.
+    //
+    // The shift has to be a float to apply it to the transforms, so the origin
+    // moves by exactly that float rather than all the way to 'newOrigin'
+    // (off by well under a millimetre). That way objects don't move in world
+    // space, however many times it's rebased. Returns the shift applied.
+    const Vector3d& GetWorldOrigin() const { return worldOrigin; }
+    Vector3 RebaseOrigin(const Vector3d& newOrigin, ThreadPool* threadPool = nullptr);
+    
+    Vector3d ToWorld(const Vector3& local) const { return worldOrigin + Vector3d(local); }
+    Vector3 ToLocal(const Vector3d& world) const { return (world - worldOrigin).ToFloat(); }
+    
+    // Changes whenever a component is added to the scene or an object is
+    // destroyed, for systems that cache which objects have which components.
+    uint64_t GetComponentVersion() const { return componentVersion; }
+    
+    // Captures the scene into a new immutable snapshot that reader threads can
+    // get at through GetSnapshots().Read(). Called at the end of each step.
+    void PublishSnapshot(uint64_t step);
+    SnapshotPublisher& GetSnapshots() { return snapshots; }
+    
+    // Walks the scene to count what it holds: objects, components per type,
+    // message handler tables and pending messages. Also includes the tracked
+    // heap usage and high-water marks per MemoryCategory, which cover every
+    // scene in the process.
+    MemoryUsageReport MemoryReport() const;
  
 private:
-    std::vector<std::shared_ptr<Object>> objects;
-    std::map<int, std::shared_ptr<Object>> objectsByID;
+    MessageStats::Result DeliverMessage(BaseMessage* msg);
+    
+    const Object* FindObject(int id) const;
+    
+    // Moves the component's data into the scene's dense per-type storage
+    void IndexComponent(const Object& object, Component* component);
+    
+    void UpdateQueries(const Object& object, uint64_t oldComponents, uint64_t oldTags, bool isNew);
+    
+    template <typename T>
+    struct PendingQuery
+    {
+        int objectID;
+        QueryResult<T> result;
+    };
+    
+    template <typename T, typename Answer>
+    void FlushPendingQueries(std::vector<PendingQuery<T>>& queries, Answer answer);
+    
+private:
+    typedef TrackingAllocator<std::shared_ptr<Object>, MemoryCategory::Objects> ObjectAllocator;
+    typedef TrackingAllocator<std::pair<const int, std::shared_ptr<Object>>, MemoryCategory::Objects> ObjectMapAllocator;
+    
+    std::vector<std::shared_ptr<Object>, ObjectAllocator> objects;
+    std::map<int, std::shared_ptr<Object>, std::less<int>, ObjectMapAllocator> objectsByID;
+    std::vector<std::string> tagNames;
+    std::vector<std::shared_ptr<ObjectQuery>> queries;
+    MessageQueue messageQueue;
+    MessageRecorder* messageRecorder = nullptr;
+    EventBus eventBus;
+    MessageStats messageStats;
+    std::vector<PendingQuery<Vector3>> pendingPositionQueries;
+    std::vector<PendingQuery<Quaternion>> pendingRotationQueries;
+    TaskScheduler taskScheduler;
+    TransformStorage transformStorage;
+    Vector3d worldOrigin;
+    uint64_t componentVersion = 0;
+    SnapshotPublisher snapshots;
     static int s_nextObjectID;
 };
 }
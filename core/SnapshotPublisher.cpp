@@ -0,0 +1,145 @@
+#include <functional>
+#include <thread>
+#include "SnapshotPublisher.hpp"
+
+namespace Core
+{
+SnapshotPublisher::ReadLock::ReadLock(ReadLock&& other) noexcept :
+    slot(other.slot),
+    snapshot(other.snapshot)
+{
+    other.slot = nullptr;
+    other.snapshot = nullptr;
+}
+
+SnapshotPublisher::ReadLock::~ReadLock()
+{
+    if (slot != nullptr)
+    {
+        slot->store(Inactive, std::memory_order_release);
+    }
+}
+
+SnapshotPublisher::SnapshotPublisher() :
+    current(nullptr),
+    epoch(0)
+{
+    for (auto& reader : readers)
+    {
+        reader.epoch.store(Inactive, std::memory_order_relaxed);
+    }
+}
+
+SnapshotPublisher::~SnapshotPublisher()
+{
+    // Readers must be finished by now
+    delete current.load();
+    delete writing;
+    
+    for (auto& entry : retired)
+    {
+        delete entry.snapshot;
+    }
+    
+    for (auto snapshot : freeSnapshots)
+    {
+        delete snapshot;
+    }
+}
+
+SnapshotPublisher::ReadLock SnapshotPublisher::Read()
+{
+    // Start looking at a slot picked from the thread ID so threads don't all
+    // fight over the first few slots.
+    size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+    
+    for (int i = 0; i < MaxReaders; ++i)
+    {
+        std::atomic<uint64_t>& slot = readers[(start + i) % MaxReaders].epoch;
+        
+        uint64_t expected = Inactive;
+        uint64_t entered = epoch.load(std::memory_order_seq_cst);
+        if (slot.compare_exchange_strong(expected, entered, std::memory_order_seq_cst))
+        {
+            // Announcing the epoch before loading the pointer is what keeps
+            // the writer from recycling the snapshot out from under us.
+            return ReadLock(&slot, current.load(std::memory_order_seq_cst));
+        }
+    }
+    
+    throw "Too many concurrent snapshot readers.";
+}
+
+WorldSnapshot& SnapshotPublisher::BeginWrite()
+{
+    if (writing == nullptr)
+    {
+        Reclaim();
+        
+        if (!freeSnapshots.empty())
+        {
+            writing = freeSnapshots.back();
+            freeSnapshots.pop_back();
+        }
+        else
+        {
+            writing = new WorldSnapshot();
+        }
+    }
+    
+    return *writing;
+}
+
+void SnapshotPublisher::Publish()
+{
+    if (writing == nullptr)
+    {
+        throw "Publish called without BeginWrite.";
+    }
+    
+    WorldSnapshot* previous = current.exchange(writing, std::memory_order_seq_cst);
+    writing = nullptr;
+    
+    if (previous != nullptr)
+    {
+        retired.push_back({ epoch.load(std::memory_order_relaxed), previous });
+    }
+    
+    epoch.fetch_add(1, std::memory_order_seq_cst);
+}
+
+void SnapshotPublisher::Reclaim()
+{
+    if (retired.empty())
+    {
+        return;
+    }
+    
+    uint64_t oldestReader = Inactive;
+    for (auto& reader : readers)
+    {
+        uint64_t readerEpoch = reader.epoch.load(std::memory_order_seq_cst);
+        if (readerEpoch < oldestReader)
+        {
+            oldestReader = readerEpoch;
+        }
+    }
+    
+    // A snapshot retired in epoch E could have been loaded by a reader that
+    // entered in E or earlier, so it's free once all readers are past E.
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); ++i)
+    {
+        if (retired[i].epoch < oldestReader)
+        {
+            freeSnapshots.push_back(retired[i].snapshot);
+        }
+        else
+        {
+            retired[kept++] = retired[i];
+        }
+    }
+    
+    retired.resize(kept);
+}
+}
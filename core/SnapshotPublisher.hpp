@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "TransformBuffer.hpp"
+
+namespace Core
+{
+// Immutable copy of the world state as it was at the end of a step
+struct WorldSnapshot
+{
+    uint64_t step = 0;
+    TransformBuffer transforms;
+};
+
+// Hands out the latest WorldSnapshot to any number of reader threads without
+// locks. The simulation thread fills and publishes a new snapshot each step,
+// readers pin whichever one is current while they iterate it.
+//
+// Old snapshots are reclaimed by epoch: each publish retires the previous
+// snapshot tagged with the current epoch, and a retired snapshot is only
+// reused once every active reader entered a later epoch. Reused snapshots keep
+// their array capacity, so publishing doesn't allocate in steady state.
+class SnapshotPublisher
+{
+public:
+    static const int MaxReaders = 64;
+    
+    // Keeps a snapshot alive for as long as it exists. Hold it briefly, a
+    // reader that never lets go stops anything newer from being reclaimed.
+    class ReadLock
+    {
+    public:
+        ReadLock(ReadLock&& other) noexcept;
+        ~ReadLock();
+        
+        // Null until the first snapshot has been published
+        const WorldSnapshot* Get() const { return snapshot; }
+        const WorldSnapshot* operator->() const { return snapshot; }
+        
+    private:
+        friend class SnapshotPublisher;
+        ReadLock(std::atomic<uint64_t>* slot, const WorldSnapshot* snapshot) : slot(slot), snapshot(snapshot) {}
+        
+        ReadLock(const ReadLock&);  // Prevent copying
+        
+    private:
+        std::atomic<uint64_t>* slot;
+        const WorldSnapshot* snapshot;
+    };
+    
+    SnapshotPublisher();
+    ~SnapshotPublisher();
+    
+    // Any thread. Throws if more than MaxReaders locks are held at once.
+    ReadLock Read();
+    
+    // Simulation thread only. BeginWrite() returns a snapshot to fill in, which
+    // becomes visible to readers when Publish() is called.
+    WorldSnapshot& BeginWrite();
+    void Publish();
+    
+    // Snapshots retired but still pinned by a reader, useful for spotting stuck readers
+    size_t GetRetiredCount() const { return retired.size(); }
+    
+private:
+    static const uint64_t Inactive = UINT64_MAX;
+    
+    struct RetiredSnapshot
+    {
+        uint64_t epoch;
+        WorldSnapshot* snapshot;
+    };
+    
+    void Reclaim();
+    
+private:
+    std::atomic<WorldSnapshot*> current;
+    std::atomic<uint64_t> epoch;
+    
+    // One per concurrent reader, holding the epoch it entered or Inactive.
+    // Padded so readers on different cores don't share cache lines.
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<uint64_t> epoch;
+    };
+    ReaderSlot readers[MaxReaders];
+    
+    // Only touched by the simulation thread
+    WorldSnapshot* writing = nullptr;
+    std::vector<RetiredSnapshot> retired;
+    std::vector<WorldSnapshot*> freeSnapshots;
+};
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include "BaseMessage.hpp"
+
+namespace Core
+{
+class TaskScheduler;
+
+// Recycles coroutine frames by size class so starting and finishing scripted
+// tasks doesn't go back to the heap once the pool has warmed up. The free
+// lists are per thread, so tasks may be created on any thread.
+class CoroutineFramePool
+{
+public:
+    static void* Allocate(size_t size);
+    static void Release(void* ptr, size_t size);
+};
+
+// Coroutine type for scripted game logic, e.g.
+//
+//     Task MoveThenWait(SceneManager& scene, int id)
+//     {
+//         scene.SendMessage(...);
+//         co_await WaitSeconds(2.0f);
+//         co_await WaitForMessage(id, MessageType::SetRotation);
+//     }
+//
+// Tasks are handed to SceneManager::StartTask, which owns them from then on.
+class Task
+{
+public:
+    struct promise_type
+    {
+        TaskScheduler* scheduler = nullptr;
+        
+        // Links the task into its scheduler's waiter list for a message, so
+        // waiting doesn't allocate
+        std::coroutine_handle<promise_type> nextWaiter;
+        bool waitFailed = false;
+        
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { throw; }   // The scheduler destroys the task and rethrows
+        
+        static void* operator new(size_t size) { return CoroutineFramePool::Allocate(size); }
+        static void operator delete(void* ptr, size_t size) { CoroutineFramePool::Release(ptr, size); }
+    };
+    
+    typedef std::coroutine_handle<promise_type> Handle;
+    
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    ~Task()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+    
+    // Gives up ownership of the coroutine, used by the scheduler
+    Handle Release() { return std::exchange(handle, nullptr); }
+    
+private:
+    explicit Task(Handle handle) : handle(handle) {}
+    
+    Task(const Task&);  // Prevent copying
+    
+private:
+    Handle handle;
+};
+
+// Suspends the task until the next TaskScheduler::Update
+struct NextFrame
+{
+    bool await_ready() const { return false; }
+    void await_suspend(Task::Handle handle);
+    void await_resume() const {}
+};
+
+// Suspends the task until the given amount of simulation time has passed
+struct WaitSeconds
+{
+    explicit WaitSeconds(float seconds) : seconds(seconds) {}
+    
+    bool await_ready() const { return seconds <= 0.0f; }
+    void await_suspend(Task::Handle handle);
+    void await_resume() const {}
+    
+    float seconds;
+};
+
+// Suspends the task until a message of the given type has been delivered to
+// the object. The task resumes on the following update, not inside the send.
+// Evaluates to false if the object was destroyed before the message arrived.
+struct WaitForMessage
+{
+    WaitForMessage(int objectID, MessageType type) : objectID(objectID), type(type) {}
+    
+    bool await_ready() const { return false; }
+    void await_suspend(Task::Handle handle);
+    bool await_resume() const { return !std::exchange(waiting.promise().waitFailed, false); }
+    
+    int objectID;
+    MessageType type;
+    Task::Handle waiting;
+};
+}
@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <new>
+#include "TaskScheduler.hpp"
+
+namespace Core
+{
+// Frames are grouped into 64 byte size classes. Anything larger than the
+// biggest class is rare enough to just use the heap directly.
+static const size_t FrameSizeClassBytes = 64;
+static const size_t FrameSizeClassCount = 32;
+
+struct FreeFrame
+{
+    FreeFrame* next;
+};
+
+// Each thread keeps its own free lists so tasks can be created anywhere
+// without locking. A frame released on another thread than it came from
+// just joins that thread's lists.
+struct FreeFrameLists
+{
+    FreeFrame* heads[FrameSizeClassCount] = {};
+    
+    ~FreeFrameLists()
+    {
+        for (FreeFrame* frame : heads)
+        {
+            while (frame != nullptr)
+            {
+                FreeFrame* next = frame->next;
+                ::operator delete(frame);
+                frame = next;
+            }
+        }
+    }
+};
+
+static thread_local FreeFrameLists t_freeFrames;
+
+void* CoroutineFramePool::Allocate(size_t size)
+{
+    size_t sizeClass = (size - 1) / FrameSizeClassBytes;
+    if (sizeClass >= FrameSizeClassCount)
+    {
+        return ::operator new(size);
+    }
+    
+    FreeFrame* frame = t_freeFrames.heads[sizeClass];
+    if (frame != nullptr)
+    {
+        t_freeFrames.heads[sizeClass] = frame->next;
+        return frame;
+    }
+    
+    return ::operator new((sizeClass + 1) * FrameSizeClassBytes);
+}
+
+void CoroutineFramePool::Release(void* ptr, size_t size)
+{
+    size_t sizeClass = (size - 1) / FrameSizeClassBytes;
+    if (sizeClass >= FrameSizeClassCount)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+    
+    FreeFrame* frame = static_cast<FreeFrame*>(ptr);
+    frame->next = t_freeFrames.heads[sizeClass];
+    t_freeFrames.heads[sizeClass] = frame;
+}
+
+static TaskScheduler& GetScheduler(Task::Handle handle)
+{
+    TaskScheduler* scheduler = handle.promise().scheduler;
+    if (scheduler == nullptr)
+    {
+        throw "Task must be started by a scheduler before it can wait.";
+    }
+    
+    return *scheduler;
+}
+
+void NextFrame::await_suspend(Task::Handle handle)
+{
+    GetScheduler(handle).WaitNextFrame(handle);
+}
+
+void WaitSeconds::await_suspend(Task::Handle handle)
+{
+    TaskScheduler& scheduler = GetScheduler(handle);
+    scheduler.WaitUntil(scheduler.GetTime() + seconds, handle);
+}
+
+void WaitForMessage::await_suspend(Task::Handle handle)
+{
+    waiting = handle;
+    GetScheduler(handle).WaitMessage(objectID, type, handle);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    for (auto handle : nextFrame)
+    {
+        handle.destroy();
+    }
+    
+    for (auto& timer : timers)
+    {
+        timer.handle.destroy();
+    }
+    
+    for (auto& waiters : messageWaiters)
+    {
+        Task::Handle handle = waiters.second.head;
+        while (handle)
+        {
+            Task::Handle next = handle.promise().nextWaiter;
+            handle.destroy();
+            handle = next;
+        }
+    }
+}
+
+void TaskScheduler::Start(Task task)
+{
+    Task::Handle handle = task.Release();
+    handle.promise().scheduler = this;
+    ++taskCount;
+    Resume(handle);
+}
+
+void TaskScheduler::Update(float deltaSeconds)
+{
+    currentTime += deltaSeconds;
+    
+    // Anything that suspends for another frame while we're resuming goes into
+    // the (now empty) nextFrame list, so swap first.
+    resuming.swap(nextFrame);
+    
+    while (!timers.empty() && timers.front().wakeTime <= currentTime)
+    {
+        std::pop_heap(timers.begin(), timers.end());
+        resuming.push_back(timers.back().handle);
+        timers.pop_back();
+    }
+    
+    for (size_t i = 0; i < resuming.size(); ++i)
+    {
+        try
+        {
+            Resume(resuming[i]);
+        }
+        catch (...)
+        {
+            // Tasks that didn't get their turn wait for the next update
+            nextFrame.insert(nextFrame.end(), resuming.begin() + i + 1, resuming.end());
+            resuming.clear();
+            throw;
+        }
+    }
+    
+    resuming.clear();
+}
+
+void TaskScheduler::WaitUntil(float wakeTime, Task::Handle handle)
+{
+    timers.push_back({ wakeTime, handle });
+    std::push_heap(timers.begin(), timers.end());
+}
+
+void TaskScheduler::WaitMessage(int objectID, MessageType type, Task::Handle handle)
+{
+    WaiterList& waiters = messageWaiters[MakeKey(objectID, type)];
+    handle.promise().nextWaiter = nullptr;
+    if (waiters.tail)
+    {
+        waiters.tail.promise().nextWaiter = handle;
+    }
+    else
+    {
+        waiters.head = handle;
+    }
+    
+    waiters.tail = handle;
+    ++messageWaiterCount;
+}
+
+void TaskScheduler::Resume(Task::Handle handle)
+{
+    // A task that throws is left at its final suspend point, so it still
+    // has to be destroyed before the exception carries on to the caller
+    try
+    {
+        handle.resume();
+    }
+    catch (...)
+    {
+        handle.destroy();
+        --taskCount;
+        throw;
+    }
+    
+    if (handle.done())
+    {
+        handle.destroy();
+        --taskCount;
+    }
+}
+
+void TaskScheduler::WakeMessageWaiters(int objectID, MessageType type)
+{
+    auto it = messageWaiters.find(MakeKey(objectID, type));
+    if (it == messageWaiters.end())
+    {
+        return;
+    }
+    
+    // Resuming here would run script code in the middle of a message send, so
+    // the tasks are picked up on the next update instead.
+    MoveToNextFrame(it->second, false);
+}
+
+void TaskScheduler::FailObjectWaiters(int objectID)
+{
+    for (size_t type = 0; type < static_cast<size_t>(MessageType::Count); ++type)
+    {
+        auto it = messageWaiters.find(MakeKey(objectID, static_cast<MessageType>(type)));
+        if (it != messageWaiters.end())
+        {
+            MoveToNextFrame(it->second, true);
+            messageWaiters.erase(it);
+        }
+    }
+}
+
+void TaskScheduler::MoveToNextFrame(WaiterList& waiters, bool failed)
+{
+    Task::Handle handle = waiters.head;
+    while (handle)
+    {
+        Task::Handle next = std::exchange(handle.promise().nextWaiter, nullptr);
+        handle.promise().waitFailed = failed;
+        nextFrame.push_back(handle);
+        --messageWaiterCount;
+        handle = next;
+    }
+    
+    waiters.head = nullptr;
+    waiters.tail = nullptr;
+}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Task.hpp"
+
+namespace Core
+{
+// Owns suspended Tasks and resumes them when what they're waiting on happens.
+// Waiting tasks are kept in flat lists that are reused every frame, so
+// resuming thousands of tasks is a linear walk with no allocation. Tasks
+// waiting on a message are linked through their promises instead.
+class TaskScheduler
+{
+public:
+    ~TaskScheduler();
+    
+    // Takes ownership of the task and runs it until its first suspension
+    void Start(Task task);
+    
+    // Advances simulation time and resumes every task whose wait is over
+    void Update(float deltaSeconds);
+    
+    // Called for every message delivered to an object
+    void NotifyMessage(int objectID, MessageType type)
+    {
+        if (messageWaiterCount != 0)
+        {
+            WakeMessageWaiters(objectID, type);
+        }
+    }
+    
+    // Wakes every task waiting on a message to this object, with the wait
+    // failed. Called when the object is destroyed.
+    void FailMessageWaiters(int objectID)
+    {
+        if (messageWaiterCount != 0)
+        {
+            FailObjectWaiters(objectID);
+        }
+    }
+    
+    size_t GetTaskCount() const { return taskCount; }
+    float GetTime() const { return currentTime; }
+    
+    void WaitNextFrame(Task::Handle handle) { nextFrame.push_back(handle); }
+    void WaitUntil(float wakeTime, Task::Handle handle);
+    void WaitMessage(int objectID, MessageType type, Task::Handle handle);
+    
+private:
+    struct Timer
+    {
+        float wakeTime;
+        Task::Handle handle;
+        
+        // Reversed so the std heap functions give us the earliest timer first
+        bool operator<(const Timer& rhs) const { return wakeTime > rhs.wakeTime; }
+    };
+    
+    static uint64_t MakeKey(int objectID, MessageType type)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(objectID)) << 32) | static_cast<uint32_t>(type);
+    }
+    
+    // Tasks waiting on one (object, type), oldest first
+    struct WaiterList
+    {
+        Task::Handle head;
+        Task::Handle tail;
+    };
+    
+    void Resume(Task::Handle handle);
+    void WakeMessageWaiters(int objectID, MessageType type);
+    void FailObjectWaiters(int objectID);
+    void MoveToNextFrame(WaiterList& waiters, bool failed);
+    
+private:
+    float currentTime = 0.0f;
+    size_t taskCount = 0;
+    
+    std::vector<Task::Handle> nextFrame;
+    std::vector<Task::Handle> resuming;
+    std::vector<Timer> timers;
+    // Entries are emptied rather than erased when woken, so a key that's
+    // waited on repeatedly only allocates once. Destroyed objects' keys are
+    // erased.
+    std::unordered_map<uint64_t, WaiterList> messageWaiters;
+    size_t messageWaiterCount = 0;
+};
+}
@@ -0,0 +1,339 @@
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "TelemetryServer.hpp"
+#include "MemoryTracker.hpp"
+#include "MessageStats.hpp"
+#include "SceneManager.hpp"
+#include "../time/PerfTimer.hpp"
+
+namespace Core
+{
+const double TelemetryServer::FrameBuckets[FrameBucketCount] = { 0.001, 0.002, 0.004, 0.008, 0.0167, 0.0333, 0.05, 0.1, 0.25, 1.0 };
+
+// Label values need backslashes, quotes and newlines escaped
+static std::string EscapeLabel(const std::string& value)
+{
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value)
+    {
+        switch (c)
+        {
+            case '\\': escaped += "\\\\"; break;
+            case '"': escaped += "\\\""; break;
+            case '\n': escaped += "\\n"; break;
+            default: escaped += c; break;
+        }
+    }
+    
+    return escaped;
+}
+
+static void SendAll(int socket, const std::string& data)
+{
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t result = send(socket, data.data() + sent, data.size() - sent, flags);
+        if (result <= 0)
+        {
+            return;
+        }
+        sent += static_cast<size_t>(result);
+    }
+}
+
+TelemetryServer::TelemetryServer()
+{
+}
+
+TelemetryServer::~TelemetryServer()
+{
+    Stop();
+}
+
+bool TelemetryServer::ListenUnix(const std::string& path)
+{
+    sockaddr_un address = {};
+    if (IsListening() || path.size() >= sizeof(address.sun_path))
+    {
+        return false;
+    }
+    
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0)
+    {
+        return false;
+    }
+    
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, path.size());
+    
+    // A socket file left behind by an earlier run would fail the bind. It's
+    // only stale if nothing answers on it, a live server keeps its socket.
+    // Anything else at the path is left alone, and the bind fails.
+    struct stat existing;
+    if (lstat(path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode))
+    {
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (probe >= 0)
+        {
+            if (connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 && errno == ECONNREFUSED)
+            {
+                unlink(path.c_str());
+            }
+            close(probe);
+        }
+    }
+    
+    if (bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(server, 8) != 0)
+    {
+        close(server);
+        return false;
+    }
+    
+    unixPath = path;
+    return StartThread(server);
+}
+
+bool TelemetryServer::ListenTCP(uint16_t requestedPort)
+{
+    if (IsListening())
+    {
+        return false;
+    }
+    
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    if (server < 0)
+    {
+        return false;
+    }
+    
+    int reuse = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    
+    // Loopback only, metrics aren't for the outside world
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(requestedPort);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    
+    socklen_t length = sizeof(address);
+    if (bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(server, 8) != 0 ||
+        getsockname(server, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+    {
+        close(server);
+        return false;
+    }
+    
+    port = ntohs(address.sin_port);
+    return StartThread(server);
+}
+
+bool TelemetryServer::StartThread(int socket)
+{
+    listenSocket = socket;
+    stopping = false;
+    thread = std::thread(&TelemetryServer::Serve, this);
+    return true;
+}
+
+void TelemetryServer::Stop()
+{
+    if (!IsListening())
+    {
+        return;
+    }
+    
+    stopping = true;
+    thread.join();
+    
+    close(listenSocket);
+    listenSocket = -1;
+    port = 0;
+    
+    if (!unixPath.empty())
+    {
+        unlink(unixPath.c_str());
+        unixPath.clear();
+    }
+}
+
+void TelemetryServer::RecordFrame(const SceneManager& sceneMgr, uint64_t frameNanoseconds)
+{
+    Add(frames, 1);
+    Add(frameNanosecondsTotal, frameNanoseconds);
+    lastFrameNanoseconds.store(frameNanoseconds, std::memory_order_relaxed);
+    
+    double seconds = frameNanoseconds / 1e9;
+    int bucket = 0;
+    while (bucket < FrameBucketCount && seconds > FrameBuckets[bucket])
+    {
+        ++bucket;
+    }
+    Add(frameBuckets[bucket], 1);
+    
+    objectCount.store(sceneMgr.GetObjectCount(), std::memory_order_relaxed);
+    transformCount.store(sceneMgr.GetTransformStorage().GetCount(), std::memory_order_relaxed);
+    pendingMessages.store(sceneMgr.GetMessageQueue().GetPendingCount(), std::memory_order_relaxed);
+    
+    const MessageStats& stats = sceneMgr.GetMessageStats();
+    for (size_t i = 0; i < MessageTypeCount; ++i)
+    {
+        const MessageTypeStats& typeStats = stats.Get(static_cast<MessageType>(i));
+        // Worked out here rather than by the reader, which could see the
+        // three counts from different frames
+        uint64_t answered = typeStats.handled + typeStats.notFound;
+        messagesHandled[i].store(typeStats.handled, std::memory_order_relaxed);
+        messagesUnhandled[i].store(typeStats.sent > answered ? typeStats.sent - answered : 0, std::memory_order_relaxed);
+        messagesNotFound[i].store(typeStats.notFound, std::memory_order_relaxed);
+    }
+}
+
+std::string TelemetryServer::Render() const
+{
+    std::ostringstream out;
+    
+    out << "# HELP engine_frames_total Simulation frames recorded.\n";
+    out << "# TYPE engine_frames_total counter\n";
+    out << "engine_frames_total " << frames.load(std::memory_order_relaxed) << "\n";
+    
+    out << "# HELP engine_frame_seconds Time taken by each frame.\n";
+    out << "# TYPE engine_frame_seconds histogram\n";
+    uint64_t cumulative = 0;
+    for (int i = 0; i <= FrameBucketCount; ++i)
+    {
+        cumulative += frameBuckets[i].load(std::memory_order_relaxed);
+        out << "engine_frame_seconds_bucket{le=\"";
+        if (i < FrameBucketCount)
+        {
+            out << FrameBuckets[i];
+        }
+        else
+        {
+            out << "+Inf";
+        }
+        out << "\"} " << cumulative << "\n";
+    }
+    out << "engine_frame_seconds_sum " << frameNanosecondsTotal.load(std::memory_order_relaxed) / 1e9 << "\n";
+    out << "engine_frame_seconds_count " << cumulative << "\n";
+    
+    out << "# HELP engine_last_frame_seconds Time taken by the most recent frame.\n";
+    out << "# TYPE engine_last_frame_seconds gauge\n";
+    out << "engine_last_frame_seconds " << lastFrameNanoseconds.load(std::memory_order_relaxed) / 1e9 << "\n";
+    
+    out << "# HELP engine_objects Objects in the scene.\n";
+    out << "# TYPE engine_objects gauge\n";
+    out << "engine_objects " << objectCount.load(std::memory_order_relaxed) << "\n";
+    
+    out << "# HELP engine_transforms Transforms in the scene's storage.\n";
+    out << "# TYPE engine_transforms gauge\n";
+    out << "engine_transforms " << transformCount.load(std::memory_order_relaxed) << "\n";
+    
+    out << "# HELP engine_messages_pending Messages queued for the next flush.\n";
+    out << "# TYPE engine_messages_pending gauge\n";
+    out << "engine_messages_pending " << pendingMessages.load(std::memory_order_relaxed) << "\n";
+    
+    out << "# HELP engine_messages_total Messages sent, by type and outcome.\n";
+    out << "# TYPE engine_messages_total counter\n";
+    for (size_t i = 0; i < MessageTypeCount; ++i)
+    {
+        const char* type = MessageStats::GetTypeName(static_cast<MessageType>(i));
+        out << "engine_messages_total{type=\"" << type << "\",result=\"handled\"} " << messagesHandled[i].load(std::memory_order_relaxed) << "\n";
+        out << "engine_messages_total{type=\"" << type << "\",result=\"unhandled\"} " << messagesUnhandled[i].load(std::memory_order_relaxed) << "\n";
+        out << "engine_messages_total{type=\"" << type << "\",result=\"not_found\"} " << messagesNotFound[i].load(std::memory_order_relaxed) << "\n";
+    }
+    
+    out << "# HELP engine_memory_bytes Tracked heap in use, by category.\n";
+    out << "# TYPE engine_memory_bytes gauge\n";
+    for (size_t i = 0; i < static_cast<size_t>(MemoryCategory::Count); ++i)
+    {
+        MemoryCategory category = static_cast<MemoryCategory>(i);
+        out << "engine_memory_bytes{category=\"" << MemoryTracker::GetCategoryName(category) << "\"} "
+            << MemoryTracker::GetUsage(category).currentBytes << "\n";
+    }
+    
+    out << "# HELP engine_memory_peak_bytes Tracked heap high-water mark, by category.\n";
+    out << "# TYPE engine_memory_peak_bytes gauge\n";
+    for (size_t i = 0; i < static_cast<size_t>(MemoryCategory::Count); ++i)
+    {
+        MemoryCategory category = static_cast<MemoryCategory>(i);
+        out << "engine_memory_peak_bytes{category=\"" << MemoryTracker::GetCategoryName(category) << "\"} "
+            << MemoryTracker::GetUsage(category).peakBytes << "\n";
+    }
+    
+    std::vector<PerfTimer::ZoneTotal> zones = PerfTimer::GetZoneTotals();
+    out << "# HELP engine_zone_seconds_total Time spent in each profiler zone.\n";
+    out << "# TYPE engine_zone_seconds_total counter\n";
+    for (const PerfTimer::ZoneTotal& zone : zones)
+    {
+        out << "engine_zone_seconds_total{zone=\"" << EscapeLabel(zone.name) << "\"} " << zone.nanoseconds / 1e9 << "\n";
+    }
+    
+    out << "# HELP engine_zone_calls_total Times each profiler zone was entered.\n";
+    out << "# TYPE engine_zone_calls_total counter\n";
+    for (const PerfTimer::ZoneTotal& zone : zones)
+    {
+        out << "engine_zone_calls_total{zone=\"" << EscapeLabel(zone.name) << "\"} " << zone.calls << "\n";
+    }
+    
+    return out.str();
+}
+
+void TelemetryServer::Serve()
+{
+    while (!stopping)
+    {
+        // Wake up now and then to notice Stop()
+        pollfd listening = { listenSocket, POLLIN, 0 };
+        if (poll(&listening, 1, 100) <= 0)
+        {
+            continue;
+        }
+        
+        int client = accept(listenSocket, nullptr, nullptr);
+        if (client < 0)
+        {
+            continue;
+        }
+        
+#ifdef SO_NOSIGPIPE
+        int noSigPipe = 1;
+        setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+        
+        // Give the client a moment to say what it wants. Plain clients may
+        // not send anything at all.
+        char request[1024];
+        ssize_t received = 0;
+        pollfd readable = { client, POLLIN, 0 };
+        if (poll(&readable, 1, 50) > 0)
+        {
+            received = recv(client, request, sizeof(request), 0);
+        }
+        
+        std::string body = Render();
+        if (received >= 3 && std::string(request, 3) == "GET")
+        {
+            std::ostringstream header;
+            header << "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " << body.size() << "\r\n\r\n";
+            SendAll(client, header.str());
+        }
+        SendAll(client, body);
+        close(client);
+    }
+}
+}
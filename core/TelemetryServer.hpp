@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "BaseMessage.hpp"
+
+namespace Core
+{
+class SceneManager;
+
+// Serves live engine metrics in the Prometheus text format from a background
+// thread, on a Unix domain socket or a loopback TCP port. Anything connecting
+// gets the current metrics and the connection closed; HTTP requests get an
+// HTTP response, so Prometheus itself can scrape a TCP port.
+//
+// The simulation thread only calls RecordFrame(), which copies a few numbers
+// into atomics with relaxed stores. It is the only writer, and every value
+// is stored whole, so a scrape never sees one half-updated. Memory comes
+// straight from MemoryTracker. Zone times are copied out of PerfTimer under
+// its lock, so a timer finishing during a scrape can wait for that copy.
+class TelemetryServer
+{
+public:
+    TelemetryServer();
+    ~TelemetryServer();
+    
+    // Both return false if the socket couldn't be set up. A server listens on
+    // one socket at a time. ListenUnix replaces a socket file left by a dead
+    // process, but not one that another server still answers on.
+    bool ListenUnix(const std::string& path);
+    bool ListenTCP(uint16_t port);  // 0 picks a free port, see GetPort()
+    void Stop();
+    
+    bool IsListening() const { return listenSocket >= 0; }
+    uint16_t GetPort() const { return port; }
+    
+    // Simulation thread only, once per frame
+    void RecordFrame(const SceneManager& sceneMgr, uint64_t frameNanoseconds);
+    
+    // The metrics as they'd be served
+    std::string Render() const;
+    
+    // Upper bounds of the frame time histogram, in seconds
+    static const int FrameBucketCount = 10;
+    static const double FrameBuckets[FrameBucketCount];
+    
+private:
+    TelemetryServer(const TelemetryServer&);    // Prevent copying
+    
+    bool StartThread(int socket);
+    void Serve();
+    
+    // Relaxed load and store, there's a single writer
+    static void Add(std::atomic<uint64_t>& counter, uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+    
+private:
+    static const size_t MessageTypeCount = static_cast<size_t>(MessageType::Count);
+    
+    std::atomic<uint64_t> frames{ 0 };
+    std::atomic<uint64_t> frameNanosecondsTotal{ 0 };
+    std::atomic<uint64_t> lastFrameNanoseconds{ 0 };
+    std::atomic<uint64_t> frameBuckets[FrameBucketCount + 1] = {};     // Last one is +Inf
+    
+    std::atomic<uint64_t> objectCount{ 0 };
+    std::atomic<uint64_t> transformCount{ 0 };
+    std::atomic<uint64_t> pendingMessages{ 0 };
+    std::atomic<uint64_t> messagesHandled[MessageTypeCount] = {};
+    std::atomic<uint64_t> messagesUnhandled[MessageTypeCount] = {};
+    std::atomic<uint64_t> messagesNotFound[MessageTypeCount] = {};
+    
+    int listenSocket = -1;
+    std::string unixPath;
+    uint16_t port = 0;
+    std::atomic<bool> stopping{ false };
+    std::thread thread;
+};
+}
@@ -0,0 +1,131 @@
+#include "ThreadPool.hpp"
+
+namespace Core
+{
+static thread_local bool s_insideParallelFor = false;
+
+ThreadPool::ThreadPool(unsigned workerCount) :
+    nextChunk(0),
+    chunksRemaining(0)
+{
+    workers.reserve(workerCount);
+    for (unsigned i = 0; i < workerCount; ++i)
+    {
+        workers.emplace_back(&ThreadPool::WorkerMain, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    
+    workReady.notify_all();
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::GetDefault()
+{
+    static ThreadPool s_pool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+    return s_pool;
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t chunkSize, const RangeFunction& fn)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    
+    if (chunkSize == 0)
+    {
+        chunkSize = 1;
+    }
+    
+    size_t chunkTotal = (count + chunkSize - 1) / chunkSize;
+    if (workers.empty() || chunkTotal == 1 || s_insideParallelFor)
+    {
+        fn(0, count);
+        return;
+    }
+    
+    std::lock_guard<std::mutex> callerLock(callerMutex);
+    std::unique_lock<std::mutex> lock(mutex);
+    
+    // Wait for stragglers from the previous loop to leave it
+    workDone.wait(lock, [this]() { return activeWorkers == 0; });
+    
+    job = &fn;
+    jobCount = count;
+    jobChunkSize = chunkSize;
+    nextChunk.store(0);
+    chunksRemaining.store(chunkTotal);
+    ++generation;
+    lock.unlock();
+    
+    workReady.notify_all();
+    
+    RunChunks();
+    
+    lock.lock();
+    workDone.wait(lock, [this]() { return chunksRemaining.load() == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::WorkerMain()
+{
+    uint64_t seenGeneration = 0;
+    
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        workReady.wait(lock, [this, seenGeneration]() { return stopping || generation != seenGeneration; });
+        if (stopping)
+        {
+            return;
+        }
+        
+        seenGeneration = generation;
+        ++activeWorkers;
+        lock.unlock();
+        
+        RunChunks();
+        
+        lock.lock();
+        --activeWorkers;
+        workDone.notify_all();
+    }
+}
+
+void ThreadPool::RunChunks()
+{
+    s_insideParallelFor = true;
+    
+    const size_t chunkTotal = (jobCount + jobChunkSize - 1) / jobChunkSize;
+    while (true)
+    {
+        size_t chunk = nextChunk.fetch_add(1);
+        if (chunk >= chunkTotal)
+        {
+            break;
+        }
+        
+        size_t begin = chunk * jobChunkSize;
+        size_t end = begin + jobChunkSize < jobCount ? begin + jobChunkSize : jobCount;
+        (*job)(begin, end);
+        
+        if (chunksRemaining.fetch_sub(1) == 1)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            workDone.notify_all();
+        }
+    }
+    
+    s_insideParallelFor = false;
+}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Core
+{
+// Fixed set of worker threads for splitting data-parallel loops into chunks.
+// The calling thread works on chunks too, so a pool with zero workers just
+// runs everything inline.
+class ThreadPool
+{
+public:
+    typedef std::function<void(size_t begin, size_t end)> RangeFunction;
+    
+    explicit ThreadPool(unsigned workerCount);
+    ~ThreadPool();
+    
+    // Shared pool sized to the machine, one worker fewer than hardware threads.
+    // Any thread may use it; loops from different threads take turns.
+    static ThreadPool& GetDefault();
+    
+    // Calls fn on [begin, end) ranges covering [0, count), at most chunkSize
+    // each, and returns once all of them are done. Calling this from inside a
+    // chunk runs the nested loop inline rather than deadlocking. Calls from
+    // several threads at once are run one after another.
+    void ParallelFor(size_t count, size_t chunkSize, const RangeFunction& fn);
+    
+    unsigned GetWorkerCount() const { return static_cast<unsigned>(workers.size()); }
+    
+private:
+    void WorkerMain();
+    void RunChunks();
+    
+private:
+    std::vector<std::thread> workers;
+    
+    // Held for a whole ParallelFor, the job state below only has one owner
+    std::mutex callerMutex;
+    
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    uint64_t generation = 0;
+    bool stopping = false;
+    
+    // The loop currently being run
+    const RangeFunction* job = nullptr;
+    size_t jobCount = 0;
+    size_t jobChunkSize = 0;
+    std::atomic<size_t> nextChunk;
+    std::atomic<size_t> chunksRemaining;
+    unsigned activeWorkers = 0;
+};
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <cmath>
+#include "TransformBuffer.hpp"
+#include "SceneManager.hpp"
+#include "ThreadPool.hpp"
+
+namespace Core
+{
+void TransformBuffer::Resize(size_t count)
+{
+    objectIDs.resize(count);
+    px.resize(count);
+    py.resize(count);
+    pz.resize(count);
+    rw.resize(count);
+    rx.resize(count);
+    ry.resize(count);
+    rz.resize(count);
+}
+
+void TransformBuffer::SetTransform(size_t index, const Vector3& position, const Quaternion& rotation)
+{
+    px[index] = position.x;
+    py[index] = position.y;
+    pz[index] = position.z;
+    rw[index] = rotation.w;
+    rx[index] = rotation.x;
+    ry[index] = rotation.y;
+    rz[index] = rotation.z;
+}
+
+void TransformBuffer::Capture(const SceneManager& sceneMgr)
+{
+    // Vector assignment reuses our existing capacity
+    *this = sceneMgr.GetTransformStorage().GetTransforms();
+}
+
+void TransformBuffer::CaptureRelative(const SceneManager& sceneMgr, const Vector3d& viewOrigin, ThreadPool* threadPool)
+{
+    const TransformBuffer& source = sceneMgr.GetTransformStorage().GetTransforms();
+    const size_t count = source.GetCount();
+    Resize(count);
+    objectIDs = source.objectIDs;
+    layoutVersion = source.layoutVersion;
+    
+    // Both are near the world origin in any scene that rebases, so the
+    // difference fits a float even when the two are far out
+    const Vector3 offset = (sceneMgr.GetWorldOrigin() - viewOrigin).ToFloat();
+    
+    if (threadPool == nullptr)
+    {
+        threadPool = &ThreadPool::GetDefault();
+    }
+    
+    threadPool->ParallelFor(count, 16384, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            px[i] = source.px[i] + offset.x;
+            py[i] = source.py[i] + offset.y;
+            pz[i] = source.pz[i] + offset.z;
+        }
+        
+        std::copy(source.rw.begin() + begin, source.rw.begin() + end, rw.begin() + begin);
+        std::copy(source.rx.begin() + begin, source.rx.begin() + end, rx.begin() + begin);
+        std::copy(source.ry.begin() + begin, source.ry.begin() + end, ry.begin() + begin);
+        std::copy(source.rz.begin() + begin, source.rz.begin() + end, rz.begin() + begin);
+    });
+}
+
+void TransformBuffer::Translate(const Vector3& offset, size_t begin, size_t end)
+{
+    float* __restrict x = px.data();
+    float* __restrict y = py.data();
+    float* __restrict z = pz.data();
+    
+    for (size_t i = begin; i < end; ++i)
+    {
+        x[i] += offset.x;
+        y[i] += offset.y;
+        z[i] += offset.z;
+    }
+}
+
+void TransformBuffer::Interpolate(const TransformBuffer& from, const TransformBuffer& to, float alpha, TransformBuffer& out)
+{
+    const size_t count = to.GetCount();
+    out.Resize(count);
+    out.objectIDs = to.objectIDs;
+    out.layoutVersion = to.layoutVersion;
+    
+    if (from.layoutVersion != to.layoutVersion || from.GetCount() != count)
+    {
+        out.px = to.px; out.py = to.py; out.pz = to.pz;
+        out.rw = to.rw; out.rx = to.rx; out.ry = to.ry; out.rz = to.rz;
+        return;
+    }
+    
+    // Each loop only touches flat float arrays with no branches, so the
+    // compiler can vectorize them.
+    for (size_t i = 0; i < count; ++i)
+    {
+        out.px[i] = from.px[i] + (to.px[i] - from.px[i]) * alpha;
+        out.py[i] = from.py[i] + (to.py[i] - from.py[i]) * alpha;
+        out.pz[i] = from.pz[i] + (to.pz[i] - from.pz[i]) * alpha;
+    }
+    
+    // Same math as Quaternion::Nlerp: take the shorter path by flipping the
+    // target's weight when the dot product is negative, then renormalize.
+    const float inverseAlpha = 1.0f - alpha;
+    for (size_t i = 0; i < count; ++i)
+    {
+        float dot = from.rw[i] * to.rw[i] + from.rx[i] * to.rx[i] + from.ry[i] * to.ry[i] + from.rz[i] * to.rz[i];
+        float t = dot < 0.0f ? -alpha : alpha;
+        
+        float w = from.rw[i] * inverseAlpha + to.rw[i] * t;
+        float x = from.rx[i] * inverseAlpha + to.rx[i] * t;
+        float y = from.ry[i] * inverseAlpha + to.ry[i] * t;
+        float z = from.rz[i] * inverseAlpha + to.rz[i] * t;
+        
+        float inverseLength = 1.0f / std::sqrt(w * w + x * x + y * y + z * z);
+        out.rw[i] = w * inverseLength;
+        out.rx[i] = x * inverseLength;
+        out.ry[i] = y * inverseLength;
+        out.rz[i] = z * inverseLength;
+    }
+}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../math/Quaternion.hpp"
+#include "../math/Vector3.hpp"
+#include "../math/Vector3d.hpp"
+
+namespace Core
+{
+class SceneManager;
+class ThreadPool;
+class TransformStorage;
+
+// Positions and rotations of every transform in a scene, stored as one array
+// per component (structure of arrays) so batch kernels can stream through
+// them. Entry i matches slot i of the scene's TransformStorage at the time of capture.
+class TransformBuffer
+{
+public:
+    size_t GetCount() const { return objectIDs.size(); }
+    uint64_t GetLayoutVersion() const { return layoutVersion; }
+    
+    int GetObjectID(size_t index) const { return objectIDs[index]; }
+    Vector3 GetPosition(size_t index) const { return Vector3(px[index], py[index], pz[index]); }
+    Quaternion GetRotation(size_t index) const { return Quaternion(rw[index], rx[index], ry[index], rz[index]); }
+    
+    void Resize(size_t count);
+    void SetTransform(size_t index, const Vector3& position, const Quaternion& rotation);
+    
+    // Copies the current state of every transform in the scene
+    void Capture(const SceneManager& sceneMgr);
+    
+    // Same, with positions relative to 'viewOrigin' (usually the camera) in
+    // world space, for rendering far from the scene's world origin. The offset
+    // is worked out in double precision and applied in parallel.
+    void CaptureRelative(const SceneManager& sceneMgr, const Vector3d& viewOrigin, ThreadPool* threadPool = nullptr);
+    
+    // Moves positions [begin, end) by 'offset'
+    void Translate(const Vector3& offset, size_t begin, size_t end);
+    
+    // Blends 'from' towards 'to' by alpha into 'out': the same math as
+    // Vector3::Lerp for positions and Quaternion::Nlerp for rotations, written
+    // out over whole arrays so it vectorizes. If the two buffers don't have the same layout (transforms were
+    // added or removed in between) 'out' just gets 'to'.
+    static void Interpolate(const TransformBuffer& from, const TransformBuffer& to, float alpha, TransformBuffer& out);
+    
+    std::vector<int> objectIDs;
+    std::vector<float> px, py, pz;
+    std::vector<float> rw, rx, ry, rz;
+    
+private:
+    friend class TransformStorage;
+    
+    uint64_t layoutVersion = 0;
+};
+}
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <functional>
+#include "TransformStorage.hpp"
+#include "Object.hpp"
+#include "ThreadPool.hpp"
+#include "../components/AngularVelocityComponent.hpp"
+#include "../components/TransformComponent.hpp"
+#include "../components/VelocityComponent.hpp"
+
+namespace Core
+{
+size_t TransformStorage::Add(const Object& object, TransformComponent* owner)
+{
+    size_t index = owners.size();
+    
+    transforms.Resize(index + 1);
+    transforms.objectIDs[index] = object.GetID();
+    transforms.SetTransform(index, owner->GetPosition(), owner->GetRotation());
+    owners.push_back(owner);
+    objects.push_back(&object);
+    
+    vx.push_back(0.0f);
+    vy.push_back(0.0f);
+    vz.push_back(0.0f);
+    wx.push_back(0.0f);
+    wy.push_back(0.0f);
+    wz.push_back(0.0f);
+    velocityOwners.push_back(nullptr);
+    angularVelocityOwners.push_back(nullptr);
+    
+    owner->AttachStorage(this, index);
+    ++transforms.layoutVersion;
+    
+    // Atomics can't be moved, so the chunk versions are copied over by hand
+    if (GetChunkCount() > chunkCapacity)
+    {
+        size_t newCapacity = std::max<size_t>(chunkCapacity * 2, 16);
+        std::unique_ptr<std::atomic<uint64_t>[]> grown(new std::atomic<uint64_t>[newCapacity]);
+        for (size_t chunk = 0; chunk < newCapacity; ++chunk)
+        {
+            grown[chunk].store(chunk < chunkCapacity ? chunkVersions[chunk].load() : 0, std::memory_order_relaxed);
+        }
+        
+        chunkVersions = std::move(grown);
+        chunkCapacity = newCapacity;
+    }
+    
+    MarkWritten(index);
+    return index;
+}
+
+void TransformStorage::AttachVelocity(size_t index, VelocityComponent* owner)
+{
+    if (velocityOwners[index] == owner)
+    {
+        return;
+    }
+    
+    Vector3 velocity = owner->GetVelocity();
+    vx[index] = velocity.x;
+    vy[index] = velocity.y;
+    vz[index] = velocity.z;
+    velocityOwners[index] = owner;
+    owner->AttachStorage(this, index);
+    ++velocityCount;
+}
+
+void TransformStorage::AttachAngularVelocity(size_t index, AngularVelocityComponent* owner)
+{
+    if (angularVelocityOwners[index] == owner)
+    {
+        return;
+    }
+    
+    Vector3 velocity = owner->GetAngularVelocity();
+    wx[index] = velocity.x;
+    wy[index] = velocity.y;
+    wz[index] = velocity.z;
+    angularVelocityOwners[index] = owner;
+    owner->AttachStorage(this, index);
+    ++angularVelocityCount;
+}
+
+void TransformStorage::RemoveSlots(std::vector<size_t>& slots)
+{
+    if (slots.empty())
+    {
+        return;
+    }
+    
+    // Highest first, so the last slot is never one still waiting to go
+    std::sort(slots.begin(), slots.end(), std::greater<size_t>());
+    
+    size_t count = owners.size();
+    for (size_t slot : slots)
+    {
+        // The components may outlive the scene's reference, so give them
+        // their data back before the slot goes away.
+        owners[slot]->DetachStorage();
+        if (velocityOwners[slot] != nullptr)
+        {
+            velocityOwners[slot]->DetachStorage();
+            --velocityCount;
+        }
+        if (angularVelocityOwners[slot] != nullptr)
+        {
+            angularVelocityOwners[slot]->DetachStorage();
+            --angularVelocityCount;
+        }
+        
+        --count;
+        if (slot != count)
+        {
+            MoveSlot(count, slot);
+        }
+    }
+    
+    // The last chunk lost its tail, so it no longer hashes the same
+    if (count != 0)
+    {
+        MarkWritten(count - 1);
+    }
+    
+    transforms.Resize(count);
+    owners.resize(count);
+    objects.resize(count);
+    vx.resize(count);
+    vy.resize(count);
+    vz.resize(count);
+    wx.resize(count);
+    wy.resize(count);
+    wz.resize(count);
+    velocityOwners.resize(count);
+    angularVelocityOwners.resize(count);
+    ++transforms.layoutVersion;
+}
+
+void TransformStorage::MarkWritten(size_t begin, size_t end, uint64_t version)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+    
+    for (size_t chunk = begin / ChunkSize; chunk <= (end - 1) / ChunkSize; ++chunk)
+    {
+        chunkVersions[chunk].store(version, std::memory_order_relaxed);
+    }
+}
+
+void TransformStorage::Clear()
+{
+    std::vector<size_t> allSlots(owners.size());
+    for (size_t i = 0; i < allSlots.size(); ++i)
+    {
+        allSlots[i] = i;
+    }
+    RemoveSlots(allSlots);
+}
+
+void TransformStorage::MoveSlot(size_t from, size_t to)
+{
+    transforms.objectIDs[to] = transforms.objectIDs[from];
+    transforms.px[to] = transforms.px[from];
+    transforms.py[to] = transforms.py[from];
+    transforms.pz[to] = transforms.pz[from];
+    transforms.rw[to] = transforms.rw[from];
+    transforms.rx[to] = transforms.rx[from];
+    transforms.ry[to] = transforms.ry[from];
+    transforms.rz[to] = transforms.rz[from];
+    
+    vx[to] = vx[from];
+    vy[to] = vy[from];
+    vz[to] = vz[from];
+    wx[to] = wx[from];
+    wy[to] = wy[from];
+    wz[to] = wz[from];
+    
+    owners[to] = owners[from];
+    owners[to]->AttachStorage(this, to);
+    objects[to] = objects[from];
+    
+    velocityOwners[to] = velocityOwners[from];
+    if (velocityOwners[to] != nullptr)
+    {
+        velocityOwners[to]->AttachStorage(this, to);
+    }
+    
+    angularVelocityOwners[to] = angularVelocityOwners[from];
+    if (angularVelocityOwners[to] != nullptr)
+    {
+        angularVelocityOwners[to]->AttachStorage(this, to);
+    }
+    
+    MarkWritten(to);
+}
+
+void TransformStorage::Translate(const Vector3& offset, ThreadPool* threadPool)
+{
+    if (threadPool == nullptr)
+    {
+        threadPool = &ThreadPool::GetDefault();
+    }
+    
+    uint64_t writeVersion = BeginWrite();
+    threadPool->ParallelFor(GetCount(), ChunkSize * 16, [&](size_t begin, size_t end)
+    {
+        MarkWritten(begin, end, writeVersion);
+        transforms.Translate(offset, begin, end);
+    });
+}
+
+size_t TransformStorage::GetMemoryUsage() const
+{
+    size_t floatCapacity = transforms.px.capacity() + transforms.py.capacity() + transforms.pz.capacity() +
+        transforms.rw.capacity() + transforms.rx.capacity() + transforms.ry.capacity() + transforms.rz.capacity() +
+        vx.capacity() + vy.capacity() + vz.capacity() + wx.capacity() + wy.capacity() + wz.capacity();
+    size_t pointerCapacity = owners.capacity() + objects.capacity() + velocityOwners.capacity() + angularVelocityOwners.capacity();
+    
+    return floatCapacity * sizeof(float) + pointerCapacity * sizeof(void*) +
+        transforms.objectIDs.capacity() * sizeof(int) + chunkCapacity * sizeof(std::atomic<uint64_t>);
+}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "TransformBuffer.hpp"
+
+class TransformComponent;
+class VelocityComponent;
+class AngularVelocityComponent;
+
+namespace Core
+{
+class Object;
+class ThreadPool;
+
+// Scene-owned structure-of-arrays home for transform data. When a
+// TransformComponent is added to a scene its position and rotation move in
+// here and the component just refers to its slot, so systems can stream over
+// every transform in the scene as flat float arrays.
+//
+// Linear and angular velocities live in arrays parallel to the transforms,
+// holding zero for objects without that component, so integration is a
+// single pass with no indirection.
+class TransformStorage
+{
+public:
+    size_t GetCount() const { return owners.size(); }
+    uint64_t GetLayoutVersion() const { return transforms.layoutVersion; }
+    
+    const TransformBuffer& GetTransforms() const { return transforms; }
+    
+    // Adopts the component's data, returns its slot
+    size_t Add(const Object& object, TransformComponent* owner);
+    void AttachVelocity(size_t index, VelocityComponent* owner);
+    void AttachAngularVelocity(size_t index, AngularVelocityComponent* owner);
+    
+    // Drops the given slots, filling each hole with the last slot so the cost
+    // is per slot removed rather than per slot kept. Components in dropped
+    // slots get their data handed back. Sorts 'slots' in the process.
+    void RemoveSlots(std::vector<size_t>& slots);
+    
+    // Hands every component its data back and empties the storage
+    void Clear();
+    
+    // Moves every position by 'offset' in one parallel pass, see
+    // SceneManager::RebaseOrigin()
+    void Translate(const Vector3& offset, ThreadPool* threadPool = nullptr);
+    
+    // Write tracking for consumers that only revisit what changed (such as
+    // WorldHasher). Slots are grouped into chunks of ChunkSize, and each chunk
+    // keeps the version of the last write batch that touched it. A writer
+    // takes a version from BeginWrite() and marks what it wrote, marking is
+    // safe from many threads at once. Adding and removing slots marks every
+    // chunk whose contents they change, so a consumer only has to follow
+    // the chunk count when the layout version moves.
+    static const size_t ChunkSize = 1024;
+    size_t GetChunkCount() const { return (GetCount() + ChunkSize - 1) / ChunkSize; }
+    uint64_t GetChunkVersion(size_t chunk) const { return chunkVersions[chunk].load(std::memory_order_relaxed); }
+    
+    uint64_t BeginWrite() { return ++writeVersion; }
+    void MarkWritten(size_t index, uint64_t version) { chunkVersions[index / ChunkSize].store(version, std::memory_order_relaxed); }
+    void MarkWritten(size_t begin, size_t end, uint64_t version);
+    void MarkWritten(size_t index) { MarkWritten(index, BeginWrite()); }
+    
+    // Bytes reserved by every array, including unused capacity
+    size_t GetMemoryUsage() const;
+    
+    size_t GetVelocityCount() const { return velocityCount; }
+    size_t GetAngularVelocityCount() const { return angularVelocityCount; }
+    
+    TransformBuffer transforms;
+    std::vector<TransformComponent*> owners;
+    
+    // The object each slot belongs to, so systems can reach its other
+    // components without looking it up by ID
+    std::vector<const Object*> objects;
+    
+    std::vector<float> vx, vy, vz;
+    std::vector<float> wx, wy, wz;
+    std::vector<VelocityComponent*> velocityOwners;
+    std::vector<AngularVelocityComponent*> angularVelocityOwners;
+    
+private:
+    void MoveSlot(size_t from, size_t to);
+    
+private:
+    size_t velocityCount = 0;
+    
+    uint64_t writeVersion = 0;
+    std::unique_ptr<std::atomic<uint64_t>[]> chunkVersions;
+    size_t chunkCapacity = 0;
+    size_t angularVelocityCount = 0;
+};
+}
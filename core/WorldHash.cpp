@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include "WorldHash.hpp"
+#include "SceneManager.hpp"
+#include "ThreadPool.hpp"
+
+namespace Core
+{
+static const size_t HashLanes = 8;
+static const uint32_t Prime1 = 2654435761u;
+static const uint32_t Prime2 = 2246822519u;
+
+static uint64_t Mix(uint64_t value)
+{
+    // splitmix64 finalizer
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ull;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+static void HashArray(uint32_t* __restrict lanes, const void* data, size_t count)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    
+    size_t i = 0;
+    for (; i + HashLanes <= count; i += HashLanes)
+    {
+        for (size_t lane = 0; lane < HashLanes; ++lane)
+        {
+            uint32_t value;
+            memcpy(&value, bytes + (i + lane) * sizeof(uint32_t), sizeof(uint32_t));
+            uint32_t mixed = lanes[lane] + value * Prime2;
+            lanes[lane] = ((mixed << 13) | (mixed >> 19)) * Prime1;
+        }
+    }
+    
+    for (; i < count; ++i)
+    {
+        uint32_t value;
+        memcpy(&value, bytes + i * sizeof(uint32_t), sizeof(uint32_t));
+        uint32_t mixed = lanes[i % HashLanes] + value * Prime2;
+        lanes[i % HashLanes] = ((mixed << 13) | (mixed >> 19)) * Prime1;
+    }
+}
+
+uint64_t WorldHasher::HashRange(const TransformBuffer& transforms, size_t begin, size_t end, bool includeObjectIDs)
+{
+    static_assert(sizeof(int) == sizeof(uint32_t) && sizeof(float) == sizeof(uint32_t), "Hashing assumes 32 bit ints and floats");
+    
+    uint32_t lanes[HashLanes];
+    for (size_t lane = 0; lane < HashLanes; ++lane)
+    {
+        lanes[lane] = Prime1 + static_cast<uint32_t>(lane);
+    }
+    
+    size_t count = end - begin;
+    if (includeObjectIDs)
+    {
+        HashArray(lanes, &transforms.objectIDs[begin], count);
+    }
+    
+    const std::vector<float>* arrays[] = { &transforms.px, &transforms.py, &transforms.pz,
+                                           &transforms.rw, &transforms.rx, &transforms.ry, &transforms.rz };
+    for (const std::vector<float>* array : arrays)
+    {
+        HashArray(lanes, &(*array)[begin], count);
+    }
+    
+    uint64_t hash = Mix(count);
+    for (size_t lane = 0; lane < HashLanes; ++lane)
+    {
+        hash = Mix(hash ^ lanes[lane]);
+    }
+    
+    return hash;
+}
+
+WorldHasher::WorldHasher(ThreadPool* threadPool) :
+    threadPool(threadPool != nullptr ? threadPool : &ThreadPool::GetDefault())
+{
+}
+
+uint64_t WorldHasher::Update(const SceneManager& sceneMgr)
+{
+    const TransformStorage& sceneStorage = sceneMgr.GetTransformStorage();
+    const size_t chunkCount = sceneStorage.GetChunkCount();
+    
+    // A new scene, or a change in what's hashed, starts over. A layout change
+    // only moves the chunk count, since the storage marks whatever chunks
+    // adding or removing slots touched.
+    if (storage != &sceneStorage || layoutVersion == UINT64_MAX)
+    {
+        storage = &sceneStorage;
+        chunkHashes.assign(chunkCount, 0);
+        hashedVersions.assign(chunkCount, UINT64_MAX);
+    }
+    else if (layoutVersion != sceneStorage.GetLayoutVersion())
+    {
+        chunkHashes.resize(chunkCount, 0);
+        hashedVersions.resize(chunkCount, UINT64_MAX);
+    }
+    layoutVersion = sceneStorage.GetLayoutVersion();
+    
+    dirtyChunks.clear();
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        uint64_t version = sceneStorage.GetChunkVersion(chunk);
+        if (version != hashedVersions[chunk])
+        {
+            hashedVersions[chunk] = version;
+            dirtyChunks.push_back(static_cast<uint32_t>(chunk));
+        }
+    }
+    
+    const TransformBuffer& transforms = sceneStorage.GetTransforms();
+    threadPool->ParallelFor(dirtyChunks.size(), 4, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            size_t chunk = dirtyChunks[i];
+            size_t first = chunk * TransformStorage::ChunkSize;
+            size_t last = std::min(first + TransformStorage::ChunkSize, transforms.GetCount());
+            chunkHashes[chunk] = HashRange(transforms, first, last, hashObjectIDs);
+        }
+    });
+    
+    rehashedChunks = dirtyChunks.size();
+    
+    worldHash = Mix(transforms.GetCount());
+    for (uint64_t chunkHash : chunkHashes)
+    {
+        worldHash = Mix(worldHash ^ chunkHash);
+    }
+    
+    return worldHash;
+}
+
+// Reads one field of slot 'index'
+static float GetField(const TransformBuffer& transforms, size_t index, WorldDiff::Field field)
+{
+    switch (field)
+    {
+        case WorldDiff::Field::PositionX: return transforms.px[index];
+        case WorldDiff::Field::PositionY: return transforms.py[index];
+        case WorldDiff::Field::PositionZ: return transforms.pz[index];
+        case WorldDiff::Field::RotationW: return transforms.rw[index];
+        case WorldDiff::Field::RotationX: return transforms.rx[index];
+        case WorldDiff::Field::RotationY: return transforms.ry[index];
+        case WorldDiff::Field::RotationZ: return transforms.rz[index];
+        default: return 0.0f;
+    }
+}
+
+static void CompareSlots(const TransformBuffer& a, size_t indexA, const TransformBuffer& b, size_t indexB,
+                         float tolerance, std::vector<WorldDiff::Difference>& out)
+{
+    for (int field = static_cast<int>(WorldDiff::Field::PositionX); field <= static_cast<int>(WorldDiff::Field::RotationZ); ++field)
+    {
+        float valueA = GetField(a, indexA, static_cast<WorldDiff::Field>(field));
+        float valueB = GetField(b, indexB, static_cast<WorldDiff::Field>(field));
+        
+        bool differs;
+        if (tolerance > 0.0f)
+        {
+            differs = !(fabsf(valueA - valueB) <= tolerance);
+        }
+        else
+        {
+            differs = memcmp(&valueA, &valueB, sizeof(float)) != 0;
+        }
+        
+        if (differs)
+        {
+            out.push_back(WorldDiff::Difference{ a.objectIDs[indexA], b.objectIDs[indexB], static_cast<WorldDiff::Field>(field), valueA, valueB });
+        }
+    }
+}
+
+std::vector<WorldDiff::Difference> WorldDiff::Compare(const SceneManager& sceneA, const SceneManager& sceneB,
+                                                      Match match, float tolerance, size_t maxDifferences)
+{
+    const TransformBuffer& a = sceneA.GetTransformStorage().GetTransforms();
+    const TransformBuffer& b = sceneB.GetTransformStorage().GetTransforms();
+    std::vector<Difference> differences;
+    
+    if (match == Match::Slot)
+    {
+        size_t common = std::min(a.GetCount(), b.GetCount());
+        const std::vector<float>* arraysA[] = { &a.px, &a.py, &a.pz, &a.rw, &a.rx, &a.ry, &a.rz };
+        const std::vector<float>* arraysB[] = { &b.px, &b.py, &b.pz, &b.rw, &b.rx, &b.ry, &b.rz };
+        for (size_t first = 0; first < common && differences.size() < maxDifferences; first += TransformStorage::ChunkSize)
+        {
+            size_t last = std::min(first + TransformStorage::ChunkSize, common);
+            
+            // Bit-identical chunks can't hold a difference at any tolerance.
+            // Comparing the arrays is exact and cheaper than hashing both.
+            bool identical = true;
+            for (size_t array = 0; array < 7 && identical; ++array)
+            {
+                identical = memcmp(&(*arraysA[array])[first], &(*arraysB[array])[first], (last - first) * sizeof(float)) == 0;
+            }
+            
+            if (identical)
+            {
+                continue;
+            }
+            
+            for (size_t i = first; i < last && differences.size() < maxDifferences; ++i)
+            {
+                CompareSlots(a, i, b, i, tolerance, differences);
+            }
+        }
+        
+        for (size_t i = common; i < a.GetCount() && differences.size() < maxDifferences; ++i)
+        {
+            differences.push_back(Difference{ a.objectIDs[i], -1, Field::Missing, 0.0f, 0.0f });
+        }
+        
+        for (size_t i = common; i < b.GetCount() && differences.size() < maxDifferences; ++i)
+        {
+            differences.push_back(Difference{ -1, b.objectIDs[i], Field::Missing, 0.0f, 0.0f });
+        }
+    }
+    else
+    {
+        std::unordered_map<int, size_t> slotsB;
+        slotsB.reserve(b.GetCount());
+        for (size_t i = 0; i < b.GetCount(); ++i)
+        {
+            slotsB.emplace(b.objectIDs[i], i);
+        }
+        
+        std::vector<bool> matchedB(b.GetCount(), false);
+        for (size_t i = 0; i < a.GetCount() && differences.size() < maxDifferences; ++i)
+        {
+            auto it = slotsB.find(a.objectIDs[i]);
+            if (it == slotsB.end())
+            {
+                differences.push_back(Difference{ a.objectIDs[i], -1, Field::Missing, 0.0f, 0.0f });
+                continue;
+            }
+            
+            CompareSlots(a, i, b, it->second, tolerance, differences);
+            matchedB[it->second] = true;
+        }
+        
+        // Whatever's left was only in B
+        for (size_t i = 0; i < b.GetCount() && differences.size() < maxDifferences; ++i)
+        {
+            if (!matchedB[i])
+            {
+                differences.push_back(Difference{ -1, b.objectIDs[i], Field::Missing, 0.0f, 0.0f });
+            }
+        }
+    }
+    
+    if (differences.size() > maxDifferences)
+    {
+        differences.resize(maxDifferences);
+    }
+    
+    return differences;
+}
+
+const char* WorldDiff::GetFieldName(Field field)
+{
+    switch (field)
+    {
+        case Field::Missing: return "Missing";
+        case Field::PositionX: return "PositionX";
+        case Field::PositionY: return "PositionY";
+        case Field::PositionZ: return "PositionZ";
+        case Field::RotationW: return "RotationW";
+        case Field::RotationX: return "RotationX";
+        case Field::RotationY: return "RotationY";
+        case Field::RotationZ: return "RotationZ";
+        default: return "Unknown";
+    }
+}
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Core
+{
+class SceneManager;
+class ThreadPool;
+class TransformBuffer;
+class TransformStorage;
+
+// Running hash of the scene's transform state (object IDs, positions and
+// rotations, bit for bit) for spotting when two simulations that should be in
+// lockstep have diverged. The storage is hashed in TransformStorage chunks,
+// and only chunks written since the last Update() are rehashed, so a scene
+// where little moves costs little to keep hashed.
+class WorldHasher
+{
+public:
+    explicit WorldHasher(ThreadPool* threadPool = nullptr);
+    
+    // On by default. Scenes whose IDs are allocated differently (two scenes in
+    // one process) only hash the same without them.
+    void SetHashObjectIDs(bool hash) { hashObjectIDs = hash; layoutVersion = UINT64_MAX; }
+    
+    // Brings the hash up to date with the scene and returns it
+    uint64_t Update(const SceneManager& sceneMgr);
+    
+    uint64_t GetHash() const { return worldHash; }
+    const std::vector<uint64_t>& GetChunkHashes() const { return chunkHashes; }
+    size_t GetRehashedChunkCount() const { return rehashedChunks; }
+    
+    // Hashes slots [begin, end) of a buffer. Eight independent 32 bit lanes
+    // per array keep the loop vectorizable.
+    static uint64_t HashRange(const TransformBuffer& transforms, size_t begin, size_t end, bool includeObjectIDs = true);
+    
+private:
+    ThreadPool* threadPool;
+    bool hashObjectIDs = true;
+    
+    const TransformStorage* storage = nullptr;
+    uint64_t layoutVersion = UINT64_MAX;
+    std::vector<uint64_t> chunkHashes;
+    std::vector<uint64_t> hashedVersions;
+    std::vector<uint32_t> dirtyChunks;
+    size_t rehashedChunks = 0;
+    uint64_t worldHash = 0;
+};
+
+// Finds exactly which objects and fields differ between two scenes
+class WorldDiff
+{
+public:
+    enum class Field
+    {
+        Missing = 0,    // The object has a transform in only one of the scenes
+        PositionX,
+        PositionY,
+        PositionZ,
+        RotationW,
+        RotationX,
+        RotationY,
+        RotationZ,
+    };
+    
+    struct Difference
+    {
+        int objectIDA;      // -1 if missing from that scene
+        int objectIDB;
+        Field field;
+        float valueA;
+        float valueB;
+    };
+    
+    // Objects are paired by ID, or by storage slot for scenes built the same
+    // way but with different IDs (two scenes in the same process, say)
+    enum class Match
+    {
+        ObjectID,
+        Slot,
+    };
+    
+    // Values further apart than 'tolerance' differ; 0 compares bits, so a
+    // sign flip on zero or a different NaN counts. Stops after
+    // 'maxDifferences'. Matching by slot skips chunks that are bit-identical.
+    static std::vector<Difference> Compare(const SceneManager& a, const SceneManager& b,
+                                           Match match = Match::ObjectID, float tolerance = 0.0f,
+                                           size_t maxDifferences = 1000);
+    
+    static const char* GetFieldName(Field field);
+};
+}
@@ -0,0 +1,399 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "WorldStreamer.hpp"
+#include "SceneManager.hpp"
+#include "../components/AngularVelocityComponent.hpp"
+#include "../components/TransformComponent.hpp"
+#include "../components/VelocityComponent.hpp"
+
+namespace Core
+{
+static const char s_cellMagic[4] = { 'C', 'E', 'L', 'L' };
+static const uint32_t s_cellVersion = 1;
+
+// Fixed size record: position as doubles, then rotation, velocity and angular
+// velocity as floats, native byte order
+static const size_t s_recordSize = 3 * sizeof(double) + 10 * sizeof(float);
+
+WorldStreamer::WorldStreamer(const Settings& settings) :
+    settings(settings)
+{
+    prefab.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    prefab.AddComponent<VelocityComponent>(Vector3::Zero);
+    prefab.AddComponent<AngularVelocityComponent>(Vector3::Zero);
+    
+    unsigned threadCount = std::max(settings.ioThreads, 1u);
+    for (unsigned i = 0; i < threadCount; ++i)
+    {
+        ioThreads.emplace_back(&WorldStreamer::IOThreadMain, this);
+    }
+}
+
+WorldStreamer::~WorldStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(ioMutex);
+        stopping = true;
+        readQueue.clear();
+    }
+    ioReady.notify_all();
+    
+    for (std::thread& thread : ioThreads)
+    {
+        thread.join();
+    }
+}
+
+CellCoord WorldStreamer::GetCell(const Vector3d& world) const
+{
+    return CellCoord{ static_cast<int>(std::floor(world.x / settings.cellSize)),
+                      static_cast<int>(std::floor(world.z / settings.cellSize)) };
+}
+
+std::string WorldStreamer::GetCellPath(const CellCoord& cell) const
+{
+    return settings.directory + "/cell_" + std::to_string(cell.x) + "_" + std::to_string(cell.z) + ".bin";
+}
+
+bool WorldStreamer::IsCellLoaded(const CellCoord& cell) const
+{
+    auto it = cells.find(cell);
+    return it != cells.end() && it->second.state == CellState::Loaded;
+}
+
+size_t WorldStreamer::GetLoadedCellCount() const
+{
+    return std::count_if(cells.begin(), cells.end(), [](const auto& entry) { return entry.second.state == CellState::Loaded; });
+}
+
+size_t WorldStreamer::GetStagedCellCount() const
+{
+    return std::count_if(cells.begin(), cells.end(), [](const auto& entry) { return entry.second.state == CellState::Staged; });
+}
+
+size_t WorldStreamer::GetReadingCellCount() const
+{
+    return std::count_if(cells.begin(), cells.end(), [](const auto& entry) { return entry.second.state == CellState::Reading; });
+}
+
+void WorldStreamer::Update(SceneManager& sceneMgr, std::span<const Vector3d> pointsOfInterest)
+{
+    // Take whatever the I/O threads have finished
+    std::vector<CompletedRead> completed;
+    {
+        std::lock_guard<std::mutex> lock(ioMutex);
+        completed.swap(completedReads);
+    }
+    
+    for (CompletedRead& read : completed)
+    {
+        // The cell may have been given up on while it was being read
+        auto it = cells.find(read.coord);
+        if (it == cells.end() || it->second.state != CellState::Reading)
+        {
+            continue;
+        }
+        
+        if (read.failed)
+        {
+            ++failedReads;
+        }
+        
+        it->second.staged = std::move(read.objects);
+        it->second.state = CellState::Staged;
+    }
+    
+    // Which cells each point wants, nearest first so they're read first
+    struct WantedCell
+    {
+        CellCoord coord;
+        int distance;
+    };
+    std::vector<WantedCell> wanted;
+    for (const Vector3d& point : pointsOfInterest)
+    {
+        CellCoord center = GetCell(point);
+        for (int dz = -settings.prefetchRadius; dz <= settings.prefetchRadius; ++dz)
+        {
+            for (int dx = -settings.prefetchRadius; dx <= settings.prefetchRadius; ++dx)
+            {
+                wanted.push_back(WantedCell{ CellCoord{ center.x + dx, center.z + dz }, std::max(std::abs(dx), std::abs(dz)) });
+            }
+        }
+    }
+    
+    // Keep the nearest distance for cells more than one point wants
+    std::sort(wanted.begin(), wanted.end(), [](const WantedCell& a, const WantedCell& b)
+    {
+        return a.coord == b.coord ? a.distance < b.distance : a.coord < b.coord;
+    });
+    wanted.erase(std::unique(wanted.begin(), wanted.end(), [](const WantedCell& a, const WantedCell& b) { return a.coord == b.coord; }), wanted.end());
+    std::stable_sort(wanted.begin(), wanted.end(), [](const WantedCell& a, const WantedCell& b) { return a.distance < b.distance; });
+    
+    std::map<CellCoord, int> distances;
+    std::vector<CellCoord> newReads;
+    for (const WantedCell& cell : wanted)
+    {
+        distances[cell.coord] = cell.distance;
+        if (cells.find(cell.coord) == cells.end())
+        {
+            cells[cell.coord] = Cell();
+            newReads.push_back(cell.coord);
+        }
+    }
+    
+    // Forget cells nobody wants any more. Reads that haven't started are
+    // cancelled, objects already in the scene are destroyed below.
+    std::vector<CellCoord> cancelled;
+    for (auto it = cells.begin(); it != cells.end();)
+    {
+        if (distances.count(it->first) != 0)
+        {
+            ++it;
+            continue;
+        }
+        
+        Cell& cell = it->second;
+        if (cell.state == CellState::Reading)
+        {
+            cancelled.push_back(it->first);
+        }
+        pendingDestroys.insert(pendingDestroys.end(), cell.objectIDs.begin(), cell.objectIDs.end());
+        it = cells.erase(it);
+    }
+    
+    if (!newReads.empty() || !cancelled.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(ioMutex);
+            for (const CellCoord& coord : cancelled)
+            {
+                readQueue.erase(std::remove(readQueue.begin(), readQueue.end(), coord), readQueue.end());
+            }
+            readQueue.insert(readQueue.end(), newReads.begin(), newReads.end());
+        }
+        ioReady.notify_all();
+    }
+    
+    // Destroy unloaded objects, then splice staged cells in the load radius
+    // nearest first. Each batch is sized from the measured cost per object to
+    // fit what's left of half the budget. The other half is headroom, since
+    // a batch now and then costs several times the average (the thread losing
+    // its core for a moment, say) however few objects it holds. A frame always
+    // gets at least one object done so streaming can't stall, but otherwise
+    // stops when nothing fits.
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    const double target = settings.spliceBudgetMilliseconds * 0.5;
+    auto batchSize = [&](BatchKind kind, size_t remaining)
+    {
+        double fits = (target - elapsed) / millisecondsPerObject[kind];
+        size_t count = fits >= static_cast<double>(remaining) ? remaining : static_cast<size_t>(std::max(fits, 0.0));
+        count = std::min(count, settings.spliceBatchSize);
+        return elapsed == 0.0 ? std::max<size_t>(count, 1) : count;
+    };
+    auto finishBatch = [&](BatchKind kind, size_t count)
+    {
+        double now = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        double perObject = (now - elapsed) / count;
+        millisecondsPerObject[kind] += (perObject - millisecondsPerObject[kind]) * 0.25;
+        elapsed = now;
+    };
+    
+    while (!pendingDestroys.empty())
+    {
+        size_t count = batchSize(Destroy, pendingDestroys.size());
+        if (count == 0)
+        {
+            break;
+        }
+        
+        DestroyBatch(sceneMgr, count);
+        finishBatch(Destroy, count);
+    }
+    
+    for (const WantedCell& wantedCell : wanted)
+    {
+        if (wantedCell.distance > settings.loadRadius)
+        {
+            break;
+        }
+        
+        Cell& cell = cells[wantedCell.coord];
+        while (cell.state == CellState::Staged || cell.state == CellState::Splicing)
+        {
+            // Empty cells cost nothing to finish
+            size_t count = cell.staged.empty() ? 0 : batchSize(Splice, cell.staged.size() - cell.spliced);
+            if (count == 0 && !cell.staged.empty())
+            {
+                break;
+            }
+            
+            SpliceBatch(sceneMgr, cell, count);
+            if (count > 0)
+            {
+                finishBatch(Splice, count);
+            }
+        }
+    }
+    
+    lastSpliceMilliseconds = elapsed;
+}
+
+void WorldStreamer::SpliceBatch(SceneManager& sceneMgr, Cell& cell, size_t count)
+{
+    cell.state = CellState::Splicing;
+    
+    // Staged values go straight into the new components before the scene
+    // adopts them, rather than through a message per field afterwards
+    size_t first = cell.spliced;
+    int firstID = sceneMgr.CreateObjects(count, prefab, [&](size_t i, const Object& object)
+    {
+        const StreamedObject& streamed = cell.staged[first + i];
+        TransformComponent* transform = static_cast<TransformComponent*>(object.GetComponent(ComponentType::Transform));
+        transform->SetPosition(sceneMgr.ToLocal(streamed.position));
+        transform->SetRotation(streamed.rotation);
+        static_cast<VelocityComponent*>(object.GetComponent(ComponentType::Velocity))->SetVelocity(streamed.velocity);
+        static_cast<AngularVelocityComponent*>(object.GetComponent(ComponentType::AngularVelocity))->SetAngularVelocity(streamed.angularVelocity);
+    });
+    
+    for (size_t i = 0; i < count; ++i)
+    {
+        cell.objectIDs.push_back(firstID + static_cast<int>(i));
+    }
+    
+    cell.spliced += count;
+    if (cell.spliced == cell.staged.size())
+    {
+        cell.state = CellState::Loaded;
+        
+        // Staging isn't needed once everything is in the scene
+        std::vector<StreamedObject>().swap(cell.staged);
+    }
+}
+
+void WorldStreamer::DestroyBatch(SceneManager& sceneMgr, size_t count)
+{
+    std::span<const int> batch(pendingDestroys.data() + pendingDestroys.size() - count, count);
+    sceneMgr.DestroyObjects(batch);
+    pendingDestroys.resize(pendingDestroys.size() - count);
+}
+
+void WorldStreamer::IOThreadMain()
+{
+    while (true)
+    {
+        CellCoord coord;
+        {
+            std::unique_lock<std::mutex> lock(ioMutex);
+            ioReady.wait(lock, [this]() { return stopping || !readQueue.empty(); });
+            if (stopping)
+            {
+                return;
+            }
+            
+            coord = readQueue.front();
+            readQueue.pop_front();
+        }
+        
+        CompletedRead read{ coord, {}, false };
+        try
+        {
+            read.objects = ReadCell(GetCellPath(coord));
+        }
+        catch (const char*)
+        {
+            read.failed = true;
+        }
+        
+        std::lock_guard<std::mutex> lock(ioMutex);
+        completedReads.push_back(std::move(read));
+    }
+}
+
+void WorldStreamer::WriteCell(const std::string& path, const std::vector<StreamedObject>& objects)
+{
+    std::vector<char> data(sizeof(s_cellMagic) + 2 * sizeof(uint32_t) + objects.size() * s_recordSize);
+    char* out = data.data();
+    
+    auto write = [&out](const void* value, size_t size)
+    {
+        std::memcpy(out, value, size);
+        out += size;
+    };
+    
+    uint32_t count = static_cast<uint32_t>(objects.size());
+    write(s_cellMagic, sizeof(s_cellMagic));
+    write(&s_cellVersion, sizeof(s_cellVersion));
+    write(&count, sizeof(count));
+    
+    for (const StreamedObject& object : objects)
+    {
+        const double position[3] = { object.position.x, object.position.y, object.position.z };
+        const float rest[10] = { object.rotation.w, object.rotation.x, object.rotation.y, object.rotation.z,
+                                 object.velocity.x, object.velocity.y, object.velocity.z,
+                                 object.angularVelocity.x, object.angularVelocity.y, object.angularVelocity.z };
+        write(position, sizeof(position));
+        write(rest, sizeof(rest));
+    }
+    
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.write(data.data(), data.size()))
+    {
+        throw "Couldn't write cell file";
+    }
+}
+
+std::vector<StreamedObject> WorldStreamer::ReadCell(const std::string& path)
+{
+    std::vector<StreamedObject> objects;
+    
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return objects;
+    }
+    
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const size_t headerSize = sizeof(s_cellMagic) + 2 * sizeof(uint32_t);
+    if (data.size() < headerSize || std::memcmp(data.data(), s_cellMagic, sizeof(s_cellMagic)) != 0)
+    {
+        throw "Not a cell file";
+    }
+    
+    uint32_t version;
+    uint32_t count;
+    std::memcpy(&version, data.data() + 4, sizeof(version));
+    std::memcpy(&count, data.data() + 8, sizeof(count));
+    if (version != s_cellVersion)
+    {
+        throw "Unsupported cell file version";
+    }
+    if (data.size() != headerSize + static_cast<size_t>(count) * s_recordSize)
+    {
+        throw "Truncated cell file";
+    }
+    
+    objects.resize(count);
+    const char* in = data.data() + headerSize;
+    for (StreamedObject& object : objects)
+    {
+        double position[3];
+        float rest[10];
+        std::memcpy(position, in, sizeof(position));
+        std::memcpy(rest, in + sizeof(position), sizeof(rest));
+        in += s_recordSize;
+        
+        object.position = Vector3d(position[0], position[1], position[2]);
+        object.rotation = Quaternion(rest[0], rest[1], rest[2], rest[3]);
+        object.velocity = Vector3(rest[4], rest[5], rest[6]);
+        object.angularVelocity = Vector3(rest[7], rest[8], rest[9]);
+    }
+    
+    return objects;
+}
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Prefab.hpp"
+#include "../math/Quaternion.hpp"
+#include "../math/Vector3.hpp"
+#include "../math/Vector3d.hpp"
+
+namespace Core
+{
+class SceneManager;
+
+// A square column of the world on the XZ plane
+struct CellCoord
+{
+    int x;
+    int z;
+    
+    bool operator==(const CellCoord& rhs) const { return x == rhs.x && z == rhs.z; }
+    bool operator<(const CellCoord& rhs) const { return x != rhs.x ? x < rhs.x : z < rhs.z; }
+};
+
+// One object as stored in a cell file, in world space
+struct StreamedObject
+{
+    Vector3d position;
+    Quaternion rotation;
+    Vector3 velocity;
+    Vector3 angularVelocity;
+};
+
+// Keeps the cells of a partitioned world around the points of interest loaded
+// into a scene. Each cell is its own file. Files are read and decoded on
+// background I/O threads into staging, and staged objects are added to the
+// scene a batch at a time from Update(), each batch sized from the measured
+// cost per object to fit what's left of that frame's time budget, so loading
+// doesn't show up as a frame spike.
+//
+// Cells within the prefetch radius of a point are read ahead into staging,
+// cells within the load radius are spliced into the scene. Spliced cells are
+// dropped again once they leave the prefetch radius, their objects destroyed
+// in batches under the same budget. Cells are read only, so changes to
+// unloaded objects are lost.
+class WorldStreamer
+{
+public:
+    struct Settings
+    {
+        std::string directory;
+        double cellSize = 256.0;
+        int loadRadius = 1;         // In cells, a square around each point
+        int prefetchRadius = 2;
+        unsigned ioThreads = 2;
+        double spliceBudgetMilliseconds = 1.0;
+        size_t spliceBatchSize = 32;     // Most objects created or destroyed at a time
+    };
+    
+    explicit WorldStreamer(const Settings& settings);
+    
+    // Waits for reads in flight. Objects already in the scene stay there.
+    ~WorldStreamer();
+    
+    // Simulation thread, once per frame
+    void Update(SceneManager& sceneMgr, std::span<const Vector3d> pointsOfInterest);
+    
+    CellCoord GetCell(const Vector3d& world) const;
+    std::string GetCellPath(const CellCoord& cell) const;
+    
+    bool IsCellLoaded(const CellCoord& cell) const;
+    size_t GetLoadedCellCount() const;
+    size_t GetStagedCellCount() const;
+    size_t GetReadingCellCount() const;
+    double GetLastSpliceMilliseconds() const { return lastSpliceMilliseconds; }
+    
+    // Cells whose file couldn't be decoded, they're treated as empty
+    size_t GetFailedReadCount() const { return failedReads; }
+    
+    // Cell files, for tools that build the world. Missing files read as empty
+    // cells, anything else that's wrong with a file throws.
+    static void WriteCell(const std::string& path, const std::vector<StreamedObject>& objects);
+    static std::vector<StreamedObject> ReadCell(const std::string& path);
+    
+private:
+    WorldStreamer(const WorldStreamer&);    // Prevent copying
+    
+    enum class CellState
+    {
+        Reading,
+        Staged,
+        Splicing,
+        Loaded
+    };
+    
+    struct Cell
+    {
+        CellState state = CellState::Reading;
+        std::vector<StreamedObject> staged;
+        size_t spliced = 0;
+        std::vector<int> objectIDs;
+    };
+    
+    struct CompletedRead
+    {
+        CellCoord coord;
+        std::vector<StreamedObject> objects;
+        bool failed;
+    };
+    
+    void IOThreadMain();
+    enum BatchKind
+    {
+        Splice = 0,
+        Destroy,
+        
+        BatchKindCount  // Must remain last
+    };
+    
+    void SpliceBatch(SceneManager& sceneMgr, Cell& cell, size_t count);
+    void DestroyBatch(SceneManager& sceneMgr, size_t count);
+    
+private:
+    Settings settings;
+    Prefab prefab;
+    std::map<CellCoord, Cell> cells;
+    double lastSpliceMilliseconds = 0.0;
+    size_t failedReads = 0;
+    std::vector<int> pendingDestroys;
+    
+    // Running averages, a guess until the first batches have been timed
+    double millisecondsPerObject[BatchKindCount] = { 0.005, 0.005 };
+    
+    // Shared with the I/O threads
+    std::mutex ioMutex;
+    std::condition_variable ioReady;
+    std::deque<CellCoord> readQueue;
+    std::vector<CompletedRead> completedReads;
+    bool stopping = false;
+    std::vector<std::thread> ioThreads;
+};
+}
@@ -1,19 +1,104 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 #include "Math.hpp"
 #include "Matrix3.hpp"
 #include "Quaternion.hpp"
 #include "Vector3.hpp"
 #include "SceneManager.hpp"
+#include "ComponentRegistry.hpp"
+#include "FrameLoop.hpp"
+#include "HardwareCounters.hpp"
+#include "LoadGenerator.hpp"
+#include "TelemetryServer.hpp"
+#include "WorldStreamer.hpp"
+#include "MessageLog.hpp"
 #include "Object.hpp"
 #include "PerfTimer.hpp"
+#include "SamplingProfiler.hpp"
+#include "ThreadPool.hpp"
+#include "Trig.hpp"
+#include "WorldHash.hpp"
 
+#include "components/AngularVelocityComponent.hpp"
+#include "components/BoundsComponent.hpp"
 #include "components/TransformComponent.hpp"
+#include "components/VelocityComponent.hpp"
 #include "messages/AddComponentMessage.hpp"
 #include "messages/SetPositionMessage.hpp"
 #include "messages/GetPositionMessage.hpp"
+#include "messages/SetRotationMessage.hpp"
+#include "messages/SetAngularVelocityMessage.hpp"
+#include "messages/SetVelocityMessage.hpp"
+#include "systems/AnimationSystem.hpp"
+#include "systems/BroadPhase.hpp"
+#include "systems/CullingSystem.hpp"
 
 using namespace Core;
 
+// A component type the engine doesn't know about, registered at runtime
+class HealthComponent : public Component
+{
+public:
+    HealthComponent() : Component(ComponentRegistry::Get().GetTypeID<HealthComponent>()) {}
+    
+    static void Reflect(ComponentRegistry& registry)
+    {
+        registry.Register<HealthComponent>("Health")
+            .Field("current", &HealthComponent::current)
+            .Field("maximum", &HealthComponent::maximum)
+            .Field("invulnerable", &HealthComponent::invulnerable);
+    }
+    
+private:
+    float current = 100.0f;
+    int maximum = 100;
+    bool invulnerable = false;
+};
+
+struct ExplosionEvent
+{
+    Vector3 position;
+    float damage;
+};
+
+Task MoveRotateAndWait(SceneManager& sceneMgr, int objectID)
+{
+    SetPositionMessage moveMsg(objectID, Vector3(5.0f, 0.0f, 0.0f));
+    sceneMgr.SendMessage(&moveMsg);
+    co_await NextFrame();
+    
+    SetRotationMessage rotateMsg(objectID, Quaternion::FromEulerAngles(0.f, Math::HalfPi, 0.f));
+    sceneMgr.SendMessage(&rotateMsg);
+    co_await WaitSeconds(2.0f);
+    
+    std::cout << "Task waited 2 seconds, now waiting for a SetPosition" << std::endl;
+    co_await WaitForMessage(objectID, MessageType::SetPosition);
+    
+    std::cout << "Task finished, position is " << sceneMgr.QueryPosition(objectID).Get() << std::endl;
+}
+
+Task WaitForDestroyedObject(int objectID)
+{
+    bool delivered = co_await WaitForMessage(objectID, MessageType::SetPosition);
+    std::cout << "Wait on a destroyed object delivered: " << delivered << std::endl;
+}
+
+Task ThrowAfterOneFrame()
+{
+    co_await NextFrame();
+    throw "Task gave up";
+}
+
 void TestSceneManager()
 {
     SceneManager sceneMgr;
@@ -57,6 +142,1198 @@ void TestSceneManager()
     sceneMgr.SendMessage(&getPosMsg);
     
     std::cout << "Position: " << getPosMsg.position << std::endl;
+    
+    // Only the last queued SetPosition for an object should be delivered
+    for (int i = 0; i < 10; ++i)
+    {
+        sceneMgr.QueueMessage(SetPositionMessage(firstObj.GetID(), Vector3((float)i, 0.0f, 0.0f)));
+    }
+    sceneMgr.FlushMessages();
+    sceneMgr.SendMessage(&getPosMsg);
+    
+    std::cout << "Position after queued sets: " << getPosMsg.position << std::endl;
+    std::cout << "Coalesced SetPosition messages: " << sceneMgr.GetMessageQueue().GetCoalescedCount(MessageType::SetPosition) << std::endl;
+    
+    // Sending to an object that doesn't exist shows up as not_found
+    SetPositionMessage lostMsg(-1, Vector3::One);
+    sceneMgr.SendMessage(&lostMsg);
+    
+    sceneMgr.TakeMessageStatsSnapshot().WriteCSV(std::cout);
+    
+    // Queries don't need a caller-owned message. Queued ones are answered together on flush.
+    QueryResult<Vector3> queuedPos = sceneMgr.QueuePositionQuery(firstObj.GetID());
+    QueryResult<Vector3> missingPos = sceneMgr.QueuePositionQuery(secondObj.GetID());
+    QueryResult<Vector3> repeatPos = sceneMgr.QueuePositionQuery(firstObj.GetID());
+    QueryResult<Vector3> unknownPos = sceneMgr.QueuePositionQuery(-1);
+    sceneMgr.FlushQueries();
+    
+    std::cout << "Queried position: " << queuedPos.Get() << std::endl;
+    std::cout << "Object without transform answered: " << missingPos.WasFound() << std::endl;
+    std::cout << "Repeat query matches: " << (repeatPos.Get() == queuedPos.Get()) << ", unknown object answered: " << unknownPos.WasFound() << std::endl;
+    std::cout << "Queried rotation: " << sceneMgr.QueryRotation(firstObj.GetID()).Get() << std::endl;
+    
+    sceneMgr.StartTask(MoveRotateAndWait(sceneMgr, firstObj.GetID()));
+    for (int frame = 0; frame < 5; ++frame)
+    {
+        sceneMgr.UpdateTasks(1.0f);
+    }
+    
+    SetPositionMessage wakeMsg(firstObj.GetID(), Vector3::Up);
+    sceneMgr.SendMessage(&wakeMsg);
+    sceneMgr.UpdateTasks(1.0f);
+    
+    std::cout << "Tasks still running: " << sceneMgr.GetTaskCount() << std::endl;
+    
+    // Destroying the object a task waits on wakes it with the wait failed
+    int doomedID = sceneMgr.CreateObject().GetID();
+    sceneMgr.StartTask(WaitForDestroyedObject(doomedID));
+    sceneMgr.DestroyObject(doomedID);
+    sceneMgr.UpdateTasks(1.0f);
+    std::cout << "Tasks still running: " << sceneMgr.GetTaskCount() << std::endl;
+    
+    // A task that throws is cleaned up before the exception reaches the caller
+    sceneMgr.StartTask(ThrowAfterOneFrame());
+    try
+    {
+        sceneMgr.UpdateTasks(1.0f);
+    }
+    catch (const char* error)
+    {
+        std::cout << "Task threw: " << error << ", tasks still running: " << sceneMgr.GetTaskCount() << std::endl;
+    }
+}
+
+void TestBulkObjects()
+{
+    SceneManager sceneMgr;
+    
+    Prefab prefab("Transform only");
+    prefab.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    
+    int firstID;
+    {
+        ScopeTimer("Create 50000 objects in bulk");
+        firstID = sceneMgr.CreateObjects(50000, prefab);
+    }
+    
+    std::cout << "Objects after bulk create: " << sceneMgr.GetObjectCount() << std::endl;
+    std::cout << "Bulk object has transform: " << sceneMgr.FindObjectByID(firstID).HasComponent(ComponentType::Transform) << std::endl;
+    
+    std::vector<int> toDestroy;
+    for (int id = firstID; id < firstID + 50000; id += 2)
+    {
+        toDestroy.push_back(id);
+    }
+    
+    size_t objectBytesBefore = MemoryTracker::GetUsage(MemoryCategory::Objects).currentBytes;
+    {
+        ScopeTimer("Destroy 25000 objects in bulk");
+        sceneMgr.DestroyObjects(toDestroy);
+    }
+    
+    // Half the batch is gone, so its objects' own lists should be released
+    // even though the batch's block is still in use
+    std::cout << "Objects after bulk destroy: " << sceneMgr.GetObjectCount() << ", object memory released: "
+              << (objectBytesBefore - MemoryTracker::GetUsage(MemoryCategory::Objects).currentBytes) / 1024 << "KB" << std::endl;
+}
+
+void TestFrameLoop()
+{
+    SceneManager sceneMgr;
+    
+    Prefab prefab;
+    prefab.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    int id = sceneMgr.CreateObjects(1, prefab);
+    
+    // Move one unit along X every 10Hz step, but render at an uneven 24Hz
+    FrameLoop loop(sceneMgr, 0.1f);
+    float x = 0.0f;
+    loop.SetStepCallback([&sceneMgr, &x, id](float)
+    {
+        x += 1.0f;
+        sceneMgr.QueueMessage(SetPositionMessage(id, Vector3(x, 0.0f, 0.0f)));
+    });
+    
+    TransformBuffer interpolated;
+    for (int frame = 0; frame < 6; ++frame)
+    {
+        int steps = loop.Tick(1.0f / 24.0f);
+        loop.Interpolate(interpolated);
+        std::cout << "Frame " << frame << " ran " << steps << " steps, alpha " << loop.GetAlpha()
+                  << ", interpolated " << interpolated.GetPosition(0) << std::endl;
+    }
+}
+
+void TestSnapshots()
+{
+    SceneManager sceneMgr;
+    
+    Prefab prefab;
+    prefab.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    int firstID = sceneMgr.CreateObjects(1000, prefab);
+    
+    // Every step moves all objects to the same X, so a consistent snapshot
+    // never has two objects that disagree.
+    FrameLoop loop(sceneMgr, 0.01f);
+    float x = 0.0f;
+    loop.SetStepCallback([&sceneMgr, &x, firstID](float)
+    {
+        x += 1.0f;
+        for (int id = firstID; id < firstID + 1000; ++id)
+        {
+            sceneMgr.QueueMessage(SetPositionMessage(id, Vector3(x, 0.0f, 0.0f)));
+        }
+    });
+    
+    std::atomic<bool> running(true);
+    std::atomic<int> snapshotsRead(0);
+    std::atomic<int> tornSnapshots(0);
+    std::thread reader([&]()
+    {
+        while (running)
+        {
+            SnapshotPublisher::ReadLock snapshot = sceneMgr.GetSnapshots().Read();
+            if (snapshot.Get() == nullptr || snapshot->transforms.GetCount() == 0)
+            {
+                continue;
+            }
+            
+            float first = snapshot->transforms.px[0];
+            for (size_t i = 0; i < snapshot->transforms.GetCount(); ++i)
+            {
+                if (snapshot->transforms.px[i] != first)
+                {
+                    ++tornSnapshots;
+                    break;
+                }
+            }
+            
+            ++snapshotsRead;
+        }
+    });
+    
+    for (int frame = 0; frame < 200; ++frame)
+    {
+        loop.Tick(0.01f);
+    }
+    
+    running = false;
+    reader.join();
+    
+    std::cout << "Snapshots read: " << (snapshotsRead > 0) << ", torn snapshots: " << tornSnapshots << std::endl;
+}
+
+void TestIntegration()
+{
+    SceneManager sceneMgr;
+    
+    Prefab prefab;
+    prefab.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    prefab.AddComponent<VelocityComponent>(Vector3(1.0f, 0.0f, 0.0f));
+    prefab.AddComponent<AngularVelocityComponent>(Vector3(0.0f, Math::HalfPi, 0.0f));
+    int id = sceneMgr.CreateObjects(1000000, prefab);
+    
+    // One second at 60Hz should move 1 unit along X and turn 90 degrees around Y
+    FrameLoop loop(sceneMgr, 1.0f / 60.0f);
+    {
+        ScopeTimer("60 integration steps of 1000000 objects");
+        for (int step = 0; step < 60; ++step)
+        {
+            loop.GetIntegrationSystem().Integrate(sceneMgr, loop.GetStepSeconds());
+        }
+    }
+    
+    std::cout << "Integrated position: " << sceneMgr.QueryPosition(id).Get() << std::endl;
+    std::cout << "Integrated rotation: " << sceneMgr.QueryRotation(id).Get() << std::endl;
+    std::cout << "Expected rotation: " << Quaternion(Math::HalfPi, Vector3::Up) << std::endl;
+}
+
+void TestSharedThreadPool()
+{
+    // Two threads running loops on the default pool at once take turns
+    // instead of trampling each other's job
+    const size_t count = 1000000;
+    std::atomic<size_t> sums[2] = { 0, 0 };
+    auto sumOnPool = [&](int slot)
+    {
+        for (int repeat = 0; repeat < 20; ++repeat)
+        {
+            ThreadPool::GetDefault().ParallelFor(count, 4096, [&](size_t begin, size_t end)
+            {
+                sums[slot].fetch_add(end - begin, std::memory_order_relaxed);
+            });
+        }
+    };
+    
+    std::thread other(sumOnPool, 1);
+    sumOnPool(0);
+    other.join();
+    
+    std::cout << "Concurrent loops on the shared pool covered every element: "
+              << (sums[0].load() == 20 * count && sums[1].load() == 20 * count ? "yes" : "no") << std::endl;
+}
+
+void TestBroadPhase()
+{
+    SceneManager sceneMgr;
+    
+    // A row of unit boxes two units apart, with every other one moving left
+    // so it drifts through its neighbour.
+    Prefab still;
+    still.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    still.AddComponent<BoundsComponent>(Vector3::Zero, Vector3(0.5f, 0.5f, 0.5f));
+    
+    Prefab moving;
+    moving.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    moving.AddComponent<BoundsComponent>(Vector3::Zero, Vector3(0.5f, 0.5f, 0.5f));
+    moving.AddComponent<VelocityComponent>(Vector3(-1.0f, 0.0f, 0.0f));
+    
+    const int count = 100000;
+    std::vector<int> ids;
+    for (int i = 0; i < count; ++i)
+    {
+        int id = sceneMgr.CreateObjects(1, (i % 2) ? moving : still);
+        SetPositionMessage placeMsg(id, Vector3(i * 2.0f, 0.0f, 0.0f));
+        sceneMgr.SendMessage(&placeMsg);
+        ids.push_back(id);
+    }
+    
+    FrameLoop loop(sceneMgr, 0.1f);
+    BroadPhase broadPhase;
+    
+    for (int step = 0; step < 15; ++step)
+    {
+        loop.Tick(0.1f);
+        broadPhase.Update(sceneMgr);
+    }
+    
+    {
+        ScopeTimer("Broad phase update of 100000 boxes");
+        broadPhase.Update(sceneMgr);
+    }
+    
+    // After 1.5 seconds each moving box overlaps the box before it by half a unit
+    std::cout << "Overlapping pairs: " << broadPhase.GetPairs().size() << " of " << broadPhase.GetBoundsCount() << " boxes" << std::endl;
+    
+    // Removing boxes moves others into their slots, but the sorted order
+    // carries over so the update after doesn't need a full sort
+    sceneMgr.DestroyObjects(std::span<const int>(ids.data(), 1000));
+    {
+        ScopeTimer("Broad phase update after destroying 1000 boxes");
+        broadPhase.Update(sceneMgr);
+    }
+    
+    BroadPhase fresh;
+    fresh.Update(sceneMgr);
+    std::cout << "Overlapping pairs after destroying: " << broadPhase.GetPairs().size() << ", from scratch: " << fresh.GetPairs().size() << std::endl;
+}
+
+void TestCulling()
+{
+    SceneManager sceneMgr;
+    
+    Prefab prefab;
+    prefab.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    
+    // A 100 x 1000 grid of objects on the XZ plane, one unit apart
+    for (int i = 0; i < 100000; ++i)
+    {
+        int id = sceneMgr.CreateObjects(1, prefab);
+        SetPositionMessage placeMsg(id, Vector3((float)(i % 100) - 50.0f, 0.0f, (float)(i / 100) - 500.0f));
+        sceneMgr.SendMessage(&placeMsg);
+    }
+    
+    std::vector<CullingView> views(5);
+    
+    // Looking down +Z from the middle of the grid
+    views[0].frustum = CullingFrustum::FromPerspective(Vector3::Zero, Matrix3::Identity, Math::HalfPi, 1.0f, 0.1f, 100.0f);
+    
+    // Everything within 10 units
+    views[1].maxDistance = 10.0f;
+    
+    // A 45 degree wide cone down +X, out to 20 units
+    views[2].coneDirection = Vector3::Right;
+    views[2].coneHalfAngle = Math::Pi / 8.0f;
+    views[2].maxDistance = 20.0f;
+    
+    // Looking down +X from the middle of the grid
+    views[3].frustum = CullingFrustum::FromPerspective(Vector3::Zero, Matrix3::FromEulerAngles(0.f, Math::HalfPi, 0.f), Math::HalfPi, 1.0f, 0.1f, 100.0f);
+    
+    // A 270 degree wide cone down +X, out to 20 units. Everything in range
+    // except a 90 degree wedge behind.
+    views[4].coneDirection = Vector3::Right;
+    views[4].coneHalfAngle = Math::Pi * 0.75f;
+    views[4].maxDistance = 20.0f;
+    
+    CullingSystem culling;
+    {
+        ScopeTimer("Culling 100000 objects for 5 views");
+        culling.Cull(sceneMgr, views);
+    }
+    
+    for (size_t v = 0; v < views.size(); ++v)
+    {
+        std::cout << "View " << v << " sees " << views[v].visible.size() << " objects" << std::endl;
+    }
+}
+
+void TestAnimation()
+{
+    // 64 tracks of 10 seconds at 30Hz: bobbing up and down while turning,
+    // each at its own speed
+    auto clip = std::make_shared<AnimationClip>(30.0f);
+    for (int track = 0; track < 64; ++track)
+    {
+        std::vector<Vector3> positions;
+        std::vector<Quaternion> rotations;
+        for (int frame = 0; frame <= 300; ++frame)
+        {
+            float t = frame / 30.0f;
+            positions.push_back(Vector3((float)track, sinf(t * (1.0f + track * 0.1f)), t));
+            rotations.push_back(Quaternion(t * (0.5f + track * 0.05f), Vector3::Up));
+        }
+        
+        clip->AddTrack(positions, rotations);
+    }
+    
+    std::cout << "Clip keeps " << clip->GetKeyCount() << " of " << 64 * 301 * 2 << " keys in "
+              << clip->GetMemoryUsage() << " bytes (" << 64 * 301 * 28 << " uncompressed)" << std::endl;
+    
+    AnimationCursor cursor;
+    Vector3 position;
+    Quaternion rotation;
+    clip->Sample(3, 2.5f, cursor, position, rotation);
+    std::cout << "Track 3 at 2.5s: " << position << " " << rotation << std::endl;
+    std::cout << "Expected: " << Vector3(3.0f, sinf(2.5f * 1.3f), 2.5f) << " " << Quaternion(2.5f * 0.65f, Vector3::Up) << std::endl;
+    
+    SceneManager sceneMgr;
+    Prefab prefab;
+    prefab.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    
+    const int trackCount = 100000;
+    int firstID = sceneMgr.CreateObjects(trackCount, prefab);
+    
+    AnimationSystem animation;
+    for (int i = 0; i < trackCount; ++i)
+    {
+        animation.Play(firstID + i, clip, i % 64, (i % 300) / 30.0f);
+    }
+    
+    // Bind everything before timing
+    animation.Update(sceneMgr, 0.0f);
+    
+    const int frames = 120;
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        animation.Update(sceneMgr, 1.0f / 60.0f);
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    unsigned cores = ThreadPool::GetDefault().GetWorkerCount() + 1;
+    std::cout << "Sampled " << (size_t)trackCount * frames << " tracks in " << seconds * 1000.0 << " milliseconds, "
+              << (trackCount * frames / seconds / cores) / 1.0e6 << " million tracks per second per core (" << cores << " cores)" << std::endl;
+    
+    // Starting one more track only looks up that object's slot
+    int lateID = sceneMgr.CreateObjects(1, prefab);
+    animation.Update(sceneMgr, 0.0f);
+    {
+        ScopeTimer("Update after starting one track among 100000");
+        animation.Play(lateID, clip, 1);
+        animation.Update(sceneMgr, 1.0f / 60.0f);
+    }
+    std::cout << "Players after the late start: " << animation.GetPlayerCount() << std::endl;
+}
+
+void TestComponentRegistry()
+{
+    ComponentRegistry& registry = ComponentRegistry::Get();
+    HealthComponent::Reflect(registry);
+    
+    SceneManager sceneMgr;
+    Prefab prefab;
+    prefab.AddComponent<TransformComponent>(Vector3(1.0f, 2.0f, 3.0f), Quaternion::Identity);
+    prefab.AddComponent<BoundsComponent>(Vector3::Zero, Vector3::One);
+    prefab.AddComponent<HealthComponent>();
+    int id = sceneMgr.CreateObjects(1, prefab);
+    
+    // Generic tooling: look fields up by name and print whatever's there
+    const Object& object = sceneMgr.FindObjectByID(id);
+    Component* health = object.GetComponent(registry.GetTypeID<HealthComponent>());
+    registry.Find("Health")->FindField("current")->set(*health, FieldValue(42.5f));
+    
+    for (const auto& component : object.GetComponents())
+    {
+        const ComponentTypeInfo* info = registry.Find(component->GetComponentType());
+        registry.Print(std::cout, *component);
+        std::cout << " (id " << (size_t)info->id << ", " << info->size << " bytes, align " << info->alignment << ")" << std::endl;
+    }
+}
+
+void TestEventBus()
+{
+    SceneManager sceneMgr;
+    EventBus& bus = sceneMgr.GetEventBus();
+    
+    Prefab prefab;
+    prefab.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    
+    // 10000 objects in a row along X, every other one tagged as an enemy
+    const uint32_t EnemyTag = 1;
+    const int count = 10000;
+    int firstID = sceneMgr.CreateObjects(count, prefab);
+    
+    size_t hits = 0;
+    float totalDamage = 0.0f;
+    for (int i = 0; i < count; ++i)
+    {
+        SetPositionMessage placeMsg(firstID + i, Vector3((float)i, 0.0f, 0.0f));
+        sceneMgr.SendMessage(&placeMsg);
+        
+        bus.Subscribe<ExplosionEvent>(firstID + i, [&](int, const ExplosionEvent& explosion)
+        {
+            ++hits;
+            totalDamage += explosion.damage;
+        }, (i % 2 == 0) ? EnemyTag : 0);
+    }
+    
+    {
+        ScopeTimer("Broadcast to 10000 subscribers");
+        bus.Publish(ExplosionEvent{ Vector3::Zero, 1.0f });
+        sceneMgr.FlushEvents();
+    }
+    std::cout << "Unfiltered explosion hit " << hits << " objects" << std::endl;
+    
+    hits = 0;
+    bus.Publish(ExplosionEvent{ Vector3(100.0f, 0.0f, 0.0f), 1.0f }, EventFilter::Within(Vector3(100.0f, 0.0f, 0.0f), 10.0f));
+    bus.Publish(ExplosionEvent{ Vector3::Zero, 1.0f }, EventFilter::Tags(EnemyTag));
+    sceneMgr.FlushEvents();
+    std::cout << "Within 10 units plus enemies only hit " << hits << " objects, expected " << 21 + count / 2 << std::endl;
+    
+    std::vector<int> destroyed;
+    for (int i = 0; i < count / 2; ++i)
+    {
+        destroyed.push_back(firstID + i);
+    }
+    sceneMgr.DestroyObjects(destroyed);
+    std::cout << "Subscribers left after destroying half: " << bus.GetSubscriberCount<ExplosionEvent>() << std::endl;
+}
+
+void TestQueries()
+{
+    SceneManager sceneMgr;
+    ObjectTag enemy = sceneMgr.GetTag("Enemy");
+    ObjectTag dead = sceneMgr.GetTag("Dead");
+    
+    Prefab scenery;
+    scenery.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    Prefab mover;
+    mover.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    mover.AddComponent<VelocityComponent>(Vector3::One);
+    
+    // Built before anything exists, then kept up to date as the scene changes
+    auto livingEnemies = sceneMgr.GetQuery(QueryFilter().With(ComponentType::Transform).WithTag(enemy).WithoutTag(dead));
+    
+    sceneMgr.CreateObjects(100000, scenery);
+    int firstMover = sceneMgr.CreateObjects(1000, mover);
+    for (int i = 0; i < 1000; ++i)
+    {
+        sceneMgr.AddTag(firstMover + i, enemy);
+    }
+    
+    for (int i = 0; i < 100; ++i)
+    {
+        sceneMgr.AddTag(firstMover + i, dead);
+    }
+    
+    std::vector<int> destroyed;
+    for (int i = 900; i < 1000; ++i)
+    {
+        destroyed.push_back(firstMover + i);
+    }
+    sceneMgr.DestroyObjects(destroyed);
+    
+    auto movers = sceneMgr.GetQuery(QueryFilter().With(ComponentType::Velocity));
+    std::cout << "Living enemies: " << livingEnemies->GetCount() << " of " << sceneMgr.GetObjectCount() << " objects, expected 800" << std::endl;
+    std::cout << "Objects with velocity: " << movers->GetCount() << ", expected 900" << std::endl;
+    
+    Vector3 sum;
+    {
+        ScopeTimer("Summing positions of living enemies");
+        for (const Object* object : livingEnemies->GetObjects())
+        {
+            sum += static_cast<const TransformComponent*>(object->GetComponent(ComponentType::Transform))->GetPosition();
+        }
+    }
+}
+
+// Fills the scene with objects placed and spinning at seeded random
+void BuildSeededWorld(SceneManager& sceneMgr, int count)
+{
+    Prefab prefab;
+    prefab.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    prefab.AddComponent<VelocityComponent>(Vector3::Zero);
+    prefab.AddComponent<AngularVelocityComponent>(Vector3::Zero);
+    
+    int firstID = sceneMgr.CreateObjects(count, prefab);
+    
+    uint32_t seed = 12345;
+    auto random = [&seed]()
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / 16777216.0f * 2.0f - 1.0f;
+    };
+    
+    for (int i = 0; i < count; ++i)
+    {
+        SetPositionMessage placeMsg(firstID + i, Vector3(random() * 100.0f, random() * 100.0f, random() * 100.0f));
+        sceneMgr.SendMessage(&placeMsg);
+        SetRotationMessage rotateMsg(firstID + i, Quaternion::FromEulerAngles(random() * Math::Pi, random() * Math::Pi, random() * Math::Pi));
+        sceneMgr.SendMessage(&rotateMsg);
+        SetVelocityMessage velocityMsg(firstID + i, Vector3(random(), random(), random()));
+        sceneMgr.SendMessage(&velocityMsg);
+        SetAngularVelocityMessage spinMsg(firstID + i, Vector3(random(), random(), random()) * Math::Pi);
+        sceneMgr.SendMessage(&spinMsg);
+    }
+}
+
+// Simulates a seeded world for 'ticks' steps and hashes every position and
+// rotation bit for bit
+uint64_t RunDeterminismWorld(int ticks)
+{
+    SceneManager sceneMgr;
+    BuildSeededWorld(sceneMgr, 10000);
+    
+    FrameLoop loop(sceneMgr, 1.0f / 60.0f);
+    for (int tick = 0; tick < ticks; ++tick)
+    {
+        loop.Tick(1.0f / 60.0f);
+    }
+    
+    // Object IDs depend on what else the process has created, so only
+    // positions and rotations are hashed here
+    WorldHasher hasher;
+    hasher.SetHashObjectIDs(false);
+    return hasher.Update(sceneMgr);
+}
+
+void TestDeterminism()
+{
+#ifdef DETERMINISTIC_MATH
+    std::cout << "Math backend: deterministic tables" << std::endl;
+#else
+    std::cout << "Math backend: platform libm" << std::endl;
+#endif
+    
+    uint64_t first;
+    {
+        ScopeTimer("600 ticks of 10000 objects");
+        first = RunDeterminismWorld(600);
+    }
+    
+    uint64_t second = RunDeterminismWorld(600);
+    std::cout << "World hash after 600 ticks: " << std::hex << first << ", rerun " << second << std::dec
+              << (first == second ? " (match)" : " (MISMATCH)") << std::endl;
+    
+#ifdef DETERMINISTIC_MATH
+    // Every DETERMINISTIC_MATH build on every platform has to land here
+    const uint64_t ExpectedHash = 0xd7aa36b8b07a0819ull;
+    std::cout << "Matches the reference hash: " << (first == ExpectedHash ? "yes" : "NO") << std::endl;
+#endif
+    
+    // Throughput of the two trig backends side by side
+    const int calls = 1000000;
+    float sum = 0.0f;
+    float maxError = 0.0f;
+    {
+        ScopeTimer("1000000 libm sinf/cosf");
+        for (int i = 0; i < calls; ++i)
+        {
+            float x = (float)i * 0.001f;
+            sum += sinf(x) + cosf(x);
+        }
+    }
+    {
+        ScopeTimer("1000000 Trig::TableSinCos");
+        for (int i = 0; i < calls; ++i)
+        {
+            float sn, cs;
+            Trig::TableSinCos((float)i * 0.001f, sn, cs);
+            sum += sn + cs;
+        }
+    }
+    {
+        ScopeTimer("1000000 libm acosf");
+        for (int i = 0; i < calls; ++i)
+        {
+            sum += acosf((float)i / calls * 2.0f - 1.0f);
+        }
+    }
+    {
+        ScopeTimer("1000000 Trig::TableAcos");
+        for (int i = 0; i < calls; ++i)
+        {
+            sum += Trig::TableAcos((float)i / calls * 2.0f - 1.0f);
+        }
+    }
+    
+    for (int i = 0; i < calls; ++i)
+    {
+        float x = (float)i * 0.001f - 500.0f;
+        float sn, cs;
+        Trig::TableSinCos(x, sn, cs);
+        maxError = std::max(maxError, std::max(fabsf(sn - sinf(x)), fabsf(cs - cosf(x))));
+        float c = (float)i / calls * 2.0f - 1.0f;
+        maxError = std::max(maxError, fabsf(Trig::TableAcos(c) - acosf(c)));
+    }
+    
+    std::cout << "Largest table error: " << maxError << " (checksum " << sum << ")" << std::endl;
+}
+
+void TestWorldHash()
+{
+    // Two scenes built the same way, as two peers in lockstep would be
+    SceneManager sceneA;
+    SceneManager sceneB;
+    BuildSeededWorld(sceneA, 100000);
+    BuildSeededWorld(sceneB, 100000);
+    
+    WorldHasher hasherA;
+    WorldHasher hasherB;
+    hasherA.SetHashObjectIDs(false);
+    hasherB.SetHashObjectIDs(false);
+    {
+        ScopeTimer("Hashing 100000 transforms from scratch");
+        hasherA.Update(sceneA);
+    }
+    hasherB.Update(sceneB);
+    std::cout << "Hashes agree: " << (hasherA.GetHash() == hasherB.GetHash()) << std::endl;
+    
+    // Knock one object in B out of place
+    int objectID = sceneB.GetTransformStorage().GetTransforms().GetObjectID(54321);
+    SetPositionMessage nudgeMsg(objectID, sceneB.QueryPosition(objectID).Get() + Vector3(0.0f, 0.001f, 0.0f));
+    sceneB.SendMessage(&nudgeMsg);
+    
+    {
+        ScopeTimer("Rehashing after one object moved");
+        hasherB.Update(sceneB);
+    }
+    std::cout << "Rehashed " << hasherB.GetRehashedChunkCount() << " of " << hasherB.GetChunkHashes().size()
+              << " chunks, hashes agree: " << (hasherA.GetHash() == hasherB.GetHash()) << std::endl;
+    
+    std::vector<WorldDiff::Difference> differences;
+    {
+        ScopeTimer("Diffing the two scenes");
+        differences = WorldDiff::Compare(sceneA, sceneB, WorldDiff::Match::Slot);
+    }
+    
+    for (const WorldDiff::Difference& difference : differences)
+    {
+        std::cout << "Object " << difference.objectIDA << " / " << difference.objectIDB << " differs in "
+                  << WorldDiff::GetFieldName(difference.field) << ": " << difference.valueA << " vs " << difference.valueB << std::endl;
+    }
+    
+    // Destroying an object moves the last one into its slot, which only
+    // dirties the two chunks involved
+    sceneA.DestroyObject(sceneA.GetTransformStorage().GetTransforms().GetObjectID(1000));
+    {
+        ScopeTimer("Rehashing after one object destroyed");
+        hasherA.Update(sceneA);
+    }
+    
+    WorldHasher freshHasher;
+    freshHasher.SetHashObjectIDs(false);
+    std::cout << "Rehashed " << hasherA.GetRehashedChunkCount() << " of " << hasherA.GetChunkHashes().size()
+              << " chunks, matches hashing from scratch: " << (hasherA.GetHash() == freshHasher.Update(sceneA)) << std::endl;
+}
+
+void TestMemoryReport()
+{
+    SceneManager sceneMgr;
+    MemoryTracker::ResetPeaks();
+    
+    Prefab prefab;
+    prefab.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    prefab.AddComponent<VelocityComponent>(Vector3::Zero);
+    int firstID = sceneMgr.CreateObjects(50000, prefab);
+    
+    // One object built by hand, with a handler of its own
+    const Object& custom = sceneMgr.CreateObject();
+    TransformComponent* transform = new TransformComponent(Vector3::Zero, Quaternion::Identity);
+    transform->RegisterMessage(MessageType::SetVelocity, [](Component*, BaseMessage*) {});
+    AddComponentMessage addCompMsg(custom.GetID(), transform);
+    sceneMgr.SendMessage(&addCompMsg);
+    
+    for (int i = 0; i < 1000; ++i)
+    {
+        sceneMgr.QueueMessage(SetPositionMessage(firstID + i, Vector3::One));
+    }
+    
+    std::cout << "With 50001 objects and 1000 queued messages:" << std::endl;
+    sceneMgr.MemoryReport().Write(std::cout);
+    
+    sceneMgr.FlushMessages();
+    
+    std::vector<int> toDestroy(50000);
+    for (int i = 0; i < 50000; ++i)
+    {
+        toDestroy[i] = firstID + i;
+    }
+    sceneMgr.DestroyObjects(toDestroy);
+    
+    std::cout << "After flushing and destroying the bulk objects:" << std::endl;
+    sceneMgr.MemoryReport().Write(std::cout);
+}
+
+void TestMessageReplay()
+{
+    const int objectCount = 10000;
+    const int frames = 120;
+    
+    // Record a run where game logic steers a few hundred objects every step
+    SceneManager recordedScene;
+    BuildSeededWorld(recordedScene, objectCount);
+    int recordedFirstID = recordedScene.GetTransformStorage().GetTransforms().GetObjectID(0);
+    
+    std::stringstream log;
+    {
+        MessageRecorder recorder(log);
+        recordedScene.SetMessageRecorder(&recorder);
+        
+        uint32_t seed = 777;
+        FrameLoop loop(recordedScene);
+        loop.SetStepCallback([&](float)
+        {
+            for (int i = 0; i < 500; ++i)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                int target = recordedFirstID + (int)(seed % objectCount);
+                float speed = (float)(seed >> 16) / 65536.0f;
+                recordedScene.QueueMessage(SetVelocityMessage(target, Vector3(speed, 0.0f, -speed)));
+                
+                GetPositionMessage getPosMsg(target);
+                recordedScene.SendMessage(&getPosMsg);
+            }
+        });
+        
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            loop.Tick(loop.GetStepSeconds());
+        }
+        
+        recordedScene.SetMessageRecorder(nullptr);
+        std::cout << "Recorded " << recorder.GetMessageCount() << " messages in " << recorder.GetFrameCount()
+                  << " frames, " << recorder.GetBytesWritten() << " bytes" << std::endl;
+    }
+    
+    // Feed the log to a second scene built the same way, stepping it the same
+    SceneManager replayScene;
+    BuildSeededWorld(replayScene, objectCount);
+    FrameLoop replayLoop(replayScene);
+    
+    MessageReplay replay(log);
+    replay.SetObjectIDOffset(replayScene.GetTransformStorage().GetTransforms().GetObjectID(0) - recordedFirstID);
+    MessageReplay::Stats stats = replay.Replay(replayScene, MessageReplay::Pacing::FullSpeed, [&replayLoop](float deltaSeconds)
+    {
+        replayLoop.Tick(deltaSeconds);
+    });
+    
+    std::cout << "Replayed " << stats.messages << " messages in " << stats.frames << " frames at full speed: "
+              << stats.seconds * 1000.0 << "ms (" << stats.messages / stats.seconds << " messages/s)" << std::endl;
+    
+    WorldHasher recordedHasher;
+    WorldHasher replayHasher;
+    recordedHasher.SetHashObjectIDs(false);
+    replayHasher.SetHashObjectIDs(false);
+    std::cout << "Replayed scene matches the recording: "
+              << (recordedHasher.Update(recordedScene) == replayHasher.Update(replayScene)) << std::endl;
+    
+    // Real time pacing takes as long as the recording did
+    replay.Rewind();
+    SceneManager pacedScene;
+    BuildSeededWorld(pacedScene, objectCount);
+    replay.SetObjectIDOffset(pacedScene.GetTransformStorage().GetTransforms().GetObjectID(0) - recordedFirstID);
+    stats = replay.Replay(pacedScene, MessageReplay::Pacing::RealTime);
+    std::cout << "Replayed in real time: " << stats.seconds * 1000.0 << "ms" << std::endl;
+}
+
+void TestLoadGenerator()
+{
+    HardwareCounters probe;
+    std::cout << "Hardware counters: " << (probe.IsAvailable() ? "available" : "not permitted, counter columns left empty") << std::endl;
+    
+    LoadProfile profile;
+    profile.frames = 30;
+    std::vector<LoadResult> results = LoadGenerator::Sweep(profile, { 1000, 10000, 100000, 1000000 }, { 1, 4 }, { 1000, 10000 }, &std::cout);
+    
+    // 10M objects only fits on bigger machines, so estimate it from the 1M
+    // single component run (with room for the build's peak) before trying
+    const LoadResult& million = results[results.size() - 4];
+    size_t neededBytes = million.memoryBytes * 10 * 3 / 2;
+    size_t availableBytes = (size_t)sysconf(_SC_AVPHYS_PAGES) * (size_t)sysconf(_SC_PAGESIZE);
+    if (neededBytes < availableBytes)
+    {
+        profile.objectCount = 10000000;
+        profile.componentsPerObject = 1;
+        profile.messagesPerFrame = 10000;
+        profile.frames = 10;
+        profile.warmupFrames = 2;
+        LoadGenerator::WriteCSVRow(std::cout, LoadGenerator::Run(profile));
+    }
+    else
+    {
+        std::cout << "Skipping 10000000 objects: needs about " << neededBytes / (1 << 20) << "MB, "
+                  << availableBytes / (1 << 20) << "MB free" << std::endl;
+    }
+}
+
+// What a scraper would see: connect, ask, read until the server hangs up
+std::string ScrapeUnixSocket(const std::string& path)
+{
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    
+    std::string response;
+    if (connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0)
+    {
+        const char request[] = "GET /metrics HTTP/1.0\r\n\r\n";
+        send(client, request, sizeof(request) - 1, 0);
+        
+        char buffer[4096];
+        ssize_t received;
+        while ((received = recv(client, buffer, sizeof(buffer), 0)) > 0)
+        {
+            response.append(buffer, received);
+        }
+    }
+    
+    close(client);
+    return response;
+}
+
+void TestTelemetry()
+{
+    SceneManager sceneMgr;
+    BuildSeededWorld(sceneMgr, 10000);
+    
+    TelemetryServer telemetry;
+    std::string path = "/tmp/engine-metrics-" + std::to_string(getpid()) + ".sock";
+    if (!telemetry.ListenUnix(path))
+    {
+        std::cout << "Couldn't listen on " << path << std::endl;
+        return;
+    }
+    
+    TelemetryServer second;
+    std::cout << "Second server took over a live socket: " << second.ListenUnix(path) << std::endl;
+    
+    int firstID = sceneMgr.GetTransformStorage().GetTransforms().GetObjectID(0);
+    FrameLoop loop(sceneMgr);
+    loop.SetTelemetry(&telemetry);
+    loop.SetStepCallback([&sceneMgr, firstID](float)
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            GetPositionMessage getPosMsg(firstID + i);
+            sceneMgr.SendMessage(&getPosMsg);
+        }
+    });
+    
+    // Scrape from another thread while the simulation runs
+    std::string scraped;
+    std::thread scraper([&scraped, &path]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        scraped = ScrapeUnixSocket(path);
+    });
+    
+    for (int frame = 0; frame < 120; ++frame)
+    {
+        loop.Tick(loop.GetStepSeconds());
+    }
+    scraper.join();
+    
+    // Just the headline numbers
+    std::istringstream lines(scraped);
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        if (line.rfind("HTTP/", 0) == 0 || line.rfind("engine_frames_total", 0) == 0 ||
+            line.rfind("engine_objects", 0) == 0 || line.rfind("engine_frame_seconds_count", 0) == 0 ||
+            line.rfind("engine_messages_total{type=\"GetPosition\"", 0) == 0)
+        {
+            std::cout << line << std::endl;
+        }
+    }
+}
+
+void TestSamplingProfiler()
+{
+    LoadProfile profile;
+    profile.objectCount = 100000;
+    profile.componentsPerObject = 2;
+    profile.frames = 30;
+    
+    if (!SamplingProfiler::Start(500))
+    {
+        std::cout << "Sampling profiler couldn't start" << std::endl;
+        return;
+    }
+    
+    {
+        ScopeTimer("Sampled load run");
+        LoadGenerator::Run(profile);
+    }
+    
+    SamplingProfiler::Stop();
+    
+    std::stringstream collapsed;
+    SamplingProfiler::WriteCollapsed(collapsed);
+    
+    // The leaf of each stack is where the time was actually spent
+    std::map<std::string, uint64_t> selfSamples;
+    std::string line;
+    while (std::getline(collapsed, line))
+    {
+        size_t countStart = line.rfind(' ');
+        size_t leafStart = line.rfind(';', countStart);
+        leafStart = leafStart == std::string::npos ? 0 : leafStart + 1;
+        selfSamples[line.substr(leafStart, countStart - leafStart)] += std::stoull(line.substr(countStart + 1));
+    }
+    
+    std::vector<std::pair<uint64_t, std::string>> hottest;
+    for (const auto& entry : selfSamples)
+    {
+        hottest.emplace_back(entry.second, entry.first);
+    }
+    std::sort(hottest.rbegin(), hottest.rend());
+    
+    std::cout << SamplingProfiler::GetSampleCount() << " samples, hottest functions:" << std::endl;
+    for (size_t i = 0; i < hottest.size() && i < 8; ++i)
+    {
+        std::cout << "  " << hottest[i].first << "  " << hottest[i].second.substr(0, 100) << std::endl;
+    }
+}
+
+// Drives an object 0.1m along X over one second, starting 50km out
+Vector3d MoveFarObject(bool rebase)
+{
+    SceneManager sceneMgr;
+    Prefab prefab;
+    prefab.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+    prefab.AddComponent<VelocityComponent>(Vector3(0.1f, 0.0f, 0.0f));
+    int id = sceneMgr.CreateObjects(1, prefab);
+    
+    const Vector3d start(50000.0, 0.0, 50000.0);
+    FrameLoop loop(sceneMgr);
+    if (rebase)
+    {
+        loop.RebaseOrigin(start);
+    }
+    
+    SetPositionMessage placeMsg(id, sceneMgr.ToLocal(start));
+    sceneMgr.SendMessage(&placeMsg);
+    
+    for (int frame = 0; frame < 60; ++frame)
+    {
+        loop.Tick(loop.GetStepSeconds());
+    }
+    
+    return sceneMgr.ToWorld(sceneMgr.QueryPosition(id).Get());
+}
+
+void TestLargeWorld()
+{
+    double withoutRebase = MoveFarObject(false).x;
+    double withRebase = MoveFarObject(true).x;
+    std::cout << std::setprecision(9);
+    std::cout << "Expected X after 1s: 50000.1" << std::endl;
+    std::cout << "Without rebasing: " << withoutRebase << std::endl;
+    std::cout << "With the origin rebased nearby: " << withRebase << std::endl;
+    std::cout << std::setprecision(6);
+    
+    // A jump of 30km can't be applied exactly as a float, the origin has to
+    // move by the rounded amount too or the object shifts in world space
+    {
+        SceneManager sceneMgr;
+        const Object& object = sceneMgr.CreateObject();
+        AddComponentMessage addTransformMsg(object.GetID(), new TransformComponent(Vector3::Zero, Quaternion::Identity));
+        sceneMgr.SendMessage(&addTransformMsg);
+        
+        const Vector3d placed(30000.25, 0.0, -30000.75);
+        SetPositionMessage placeMsg(object.GetID(), sceneMgr.ToLocal(placed));
+        sceneMgr.SendMessage(&placeMsg);
+        sceneMgr.RebaseOrigin(Vector3d(30000.1234567, 0.0, -30000.7654321));
+        
+        Vector3d moved = sceneMgr.ToWorld(sceneMgr.QueryPosition(object.GetID()).Get()) - placed;
+        std::cout << "World position change from a 30km rebase: " << moved.Length() * 1000.0 << "mm" << std::endl;
+    }
+    
+    // Animation clips are world space, so an animated object doesn't jump
+    // when the origin moves under it
+    {
+        SceneManager sceneMgr;
+        Prefab prefab;
+        prefab.AddComponent<TransformComponent>(Vector3::Zero, Quaternion::Identity);
+        int id = sceneMgr.CreateObjects(1, prefab);
+        
+        auto clip = std::make_shared<AnimationClip>(30.0f);
+        clip->AddTrack({ Vector3(1000.0f, 0.0f, 0.0f), Vector3(1000.0f, 0.0f, 0.0f) }, { Quaternion::Identity, Quaternion::Identity });
+        
+        AnimationSystem animation;
+        animation.Play(id, clip, 0);
+        animation.Update(sceneMgr, 0.0f);
+        sceneMgr.RebaseOrigin(Vector3d(990.0, 0.0, 0.0));
+        animation.Update(sceneMgr, 0.0f);
+        
+        std::cout << "Animated object after a rebase, local: " << sceneMgr.QueryPosition(id).Get()
+                  << " world X: " << sceneMgr.ToWorld(sceneMgr.QueryPosition(id).Get()).x << std::endl;
+    }
+    
+    SceneManager sceneMgr;
+    BuildSeededWorld(sceneMgr, 1000000);
+    
+    {
+        ScopeTimer("Rebasing 1000000 transforms");
+        sceneMgr.RebaseOrigin(Vector3d(20000.0, 0.0, -35000.0));
+    }
+    
+    TransformBuffer cameraSpace;
+    {
+        ScopeTimer("Camera relative capture of 1000000 transforms");
+        cameraSpace.CaptureRelative(sceneMgr, Vector3d(20010.0, 5.0, -35000.0));
+    }
+    
+    std::cout << "First transform, local: " << sceneMgr.GetTransformStorage().GetTransforms().GetPosition(0)
+              << " camera relative: " << cameraSpace.GetPosition(0) << std::endl;
+}
+
+void TestWorldStreaming()
+{
+    char directory[] = "/tmp/engine-cells-XXXXXX";
+    if (mkdtemp(directory) == nullptr)
+    {
+        std::cout << "Couldn't make a directory for the cells" << std::endl;
+        return;
+    }
+    
+    WorldStreamer::Settings settings;
+    settings.directory = directory;
+    settings.cellSize = 256.0;
+    settings.loadRadius = 1;
+    settings.prefetchRadius = 2;
+    
+    // A 16 x 4 strip of cells 30km out, 2000 objects each
+    const int cellsX = 16;
+    const int cellsZ = 4;
+    const Vector3d worldCorner(30000.0, 0.0, 30000.0);
+    std::vector<std::string> paths;
+    {
+        WorldStreamer writer(settings);
+        CellCoord corner = writer.GetCell(worldCorner);
+        uint32_t seed = 99;
+        auto random = [&seed]()
+        {
+            seed = seed * 1664525u + 1013904223u;
+            return (double)(seed >> 8) / 16777216.0;
+        };
+        
+        for (int z = 0; z < cellsZ; ++z)
+        {
+            for (int x = 0; x < cellsX; ++x)
+            {
+                CellCoord cell{ corner.x + x, corner.z + z };
+                std::vector<StreamedObject> objects(2000);
+                for (StreamedObject& object : objects)
+                {
+                    object.position = Vector3d((cell.x + random()) * settings.cellSize, random() * 50.0, (cell.z + random()) * settings.cellSize);
+                    object.rotation = Quaternion::Identity;
+                    object.velocity = Vector3((float)random(), 0.0f, 0.0f);
+                    object.angularVelocity = Vector3::Zero;
+                }
+                
+                paths.push_back(writer.GetCellPath(cell));
+                WorldStreamer::WriteCell(paths.back(), objects);
+            }
+        }
+    }
+    
+    SceneManager sceneMgr;
+    FrameLoop loop(sceneMgr);
+    WorldStreamer streamer(settings);
+    
+    // Fly along the strip, keeping the origin near the camera
+    Vector3d camera = worldCorner + Vector3d(0.0, 10.0, 512.0);
+    loop.RebaseOrigin(camera);
+    
+    // Frames are paced like a 120Hz game's, so the I/O threads get the idle
+    // time between them they would in a real one
+    const std::chrono::microseconds framePeriod(8333);
+    auto nextFrame = std::chrono::steady_clock::now();
+    
+    // Wall time is what the budget is for, but on a machine with few cores
+    // the I/O threads can preempt the splice, so the main thread's own CPU
+    // time is tracked too
+    auto threadMilliseconds = []()
+    {
+        timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return now.tv_sec * 1000.0 + now.tv_nsec / 1.0e6;
+    };
+    
+    double worstSplice = 0.0;
+    double worstSpliceCPU = 0.0;
+    double worstFrame = 0.0;
+    int overBudget = 0;
+    int overBudgetCPU = 0;
+    for (int frame = 0; frame < 600; ++frame)
+    {
+        nextFrame += framePeriod;
+        std::this_thread::sleep_until(nextFrame);
+        
+        camera += Vector3d(3.0, 0.0, 0.0);
+        if ((camera - sceneMgr.GetWorldOrigin()).Length() > 1000.0)
+        {
+            loop.RebaseOrigin(camera);
+        }
+        
+        auto frameStart = std::chrono::steady_clock::now();
+        double spliceStartCPU = threadMilliseconds();
+        streamer.Update(sceneMgr, std::span<const Vector3d>(&camera, 1));
+        double spliceCPU = threadMilliseconds() - spliceStartCPU;
+        loop.Tick(loop.GetStepSeconds());
+        double frameMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        
+        worstSplice = std::max(worstSplice, streamer.GetLastSpliceMilliseconds());
+        worstSpliceCPU = std::max(worstSpliceCPU, spliceCPU);
+        worstFrame = std::max(worstFrame, frameMilliseconds);
+        if (streamer.GetLastSpliceMilliseconds() > settings.spliceBudgetMilliseconds)
+        {
+            std::cout << "Frame " << frame << " over the streaming budget: " << streamer.GetLastSpliceMilliseconds()
+                      << "ms, " << spliceCPU << "ms on the CPU" << std::endl;
+            ++overBudget;
+        }
+        overBudgetCPU += spliceCPU > settings.spliceBudgetMilliseconds;
+        
+        if (frame % 150 == 0)
+        {
+            std::cout << "Frame " << frame << ": " << sceneMgr.GetObjectCount() << " objects, "
+                      << streamer.GetLoadedCellCount() << " cells loaded, " << streamer.GetStagedCellCount() << " staged, "
+                      << streamer.GetReadingCellCount() << " reading" << std::endl;
+        }
+    }
+    
+    std::cout << "Worst streaming time " << worstSplice << "ms, " << worstSpliceCPU << "ms on the CPU (budget "
+              << settings.spliceBudgetMilliseconds << "ms, " << overBudget << " of 600 frames over, " << overBudgetCPU
+              << " on the CPU), worst frame " << worstFrame << "ms" << std::endl;
+    
+    for (const std::string& path : paths)
+    {
+        unlink(path.c_str());
+    }
+    rmdir(directory);
 }
 
 void TestMath()
@@ -189,12 +1466,101 @@ void TestMath()
 
 int main()
 {
+    if (!PerfTimer::EnableHardwareCounters(true))
+    {
+        std::cout << "Hardware counters aren't available, timers will report time only" << std::endl;
+    }
+    
     TestSceneManager();
     
     std::cout << std::endl;
     
+    TestBulkObjects();
+    
+    std::cout << std::endl;
+    
+    TestFrameLoop();
+    
+    std::cout << std::endl;
+    
+    TestSnapshots();
+    
+    std::cout << std::endl;
+    
+    TestIntegration();
+    
+    std::cout << std::endl;
+    
+    TestSharedThreadPool();
+    
+    std::cout << std::endl;
+    
+    TestBroadPhase();
+    
+    std::cout << std::endl;
+    
+    TestCulling();
+    
+    std::cout << std::endl;
+    
+    TestAnimation();
+    
+    std::cout << std::endl;
+    
+    TestComponentRegistry();
+    
+    std::cout << std::endl;
+    
+    TestEventBus();
+    
+    std::cout << std::endl;
+    
+    TestQueries();
+    
+    std::cout << std::endl;
+    
+    TestDeterminism();
+    
+    std::cout << std::endl;
+    
+    TestWorldHash();
+    
+    std::cout << std::endl;
+    
+    TestMemoryReport();
+    
+    std::cout << std::endl;
+    
+    TestMessageReplay();
+    
+    std::cout << std::endl;
+    
+    TestLoadGenerator();
+    
+    std::cout << std::endl;
+    
+    TestTelemetry();
+    
+    std::cout << std::endl;
+    
+    TestSamplingProfiler();
+    
+    std::cout << std::endl;
+    
+    TestLargeWorld();
+    
+    std::cout << std::endl;
+    
+    TestWorldStreaming();
+    
+    std::cout << std::endl;
+    
     TestMath();
     
+    std::cout << std::endl;
+    
+    PerfTimer::WriteReport(std::cout);
+    
     std::cout << std::endl;
     return 0;
 }
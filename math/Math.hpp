@@ -1,5 +1,7 @@
 #pragma once
 
+#include "MathConfig.hpp"
+
 class Math
 {
 public:
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cfloat>
+
+// Define DETERMINISTIC_MATH for builds that must produce bit-identical
+// simulation results on every compiler and CPU (lockstep multiplayer,
+// replays). Float +, -, *, / and sqrt are exactly specified by IEEE 754, so
+// the engine keeps using float and instead rules out the things that aren't:
+//  - libm sin/cos/acos, which Trig replaces with lookup tables
+//  - fused multiply-add contraction, which compilers apply differently
+//  - excess precision intermediates (x87) and -ffast-math
+#ifdef DETERMINISTIC_MATH
+
+#if defined(__FAST_MATH__)
+#error "DETERMINISTIC_MATH can't be used with -ffast-math"
+#endif
+
+#if FLT_EVAL_METHOD != 0
+#error "DETERMINISTIC_MATH needs floats evaluated at float precision (SSE or NEON, not x87)"
+#endif
+
+// Compilers contract a * b + c into an FMA wherever the target has one
+// (Clang by default on ARM, GCC for C++ on any FMA target), which rounds
+// once instead of twice. Only the -ffp-contract=off flag turns that off for
+// every translation unit, and no macro reports it, so builds that pass it
+// also define DETERMINISTIC_MATH_FP_CONTRACT_OFF. Targets without FMA can't
+// contract, so they don't need it.
+#if (defined(__FP_FAST_FMA) || defined(__FP_FAST_FMAF)) && !defined(DETERMINISTIC_MATH_FP_CONTRACT_OFF)
+#error "DETERMINISTIC_MATH on an FMA target needs -ffp-contract=off and DETERMINISTIC_MATH_FP_CONTRACT_OFF defined"
+#endif
+
+#endif
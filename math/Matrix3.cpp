@@ -1,13 +1,16 @@
 #include "Vector3.hpp"
 #include "Quaternion.hpp"
 #include "Matrix3.hpp"
+#include "Trig.hpp"
 
 #include <sstream>
 
 
 // NOTE: Matrices in this game engine are row-major.
 
-const Matrix3 Matrix3::Identity(Vector3::Right, Vector3::Up, Vector3::Forward);
+// Spelled out rather than built from Vector3::Right etc., which may not be
+// initialized yet when this translation unit's statics are
+const Matrix3 Matrix3::Identity(Vector3(1.f, 0.f, 0.f), Vector3(0.f, 1.f, 0.f), Vector3(0.f, 0.f, 1.f));
 
 Matrix3::Matrix3(const Vector3& row0, const Vector3& row1, const Vector3& row2)
 {
@@ -31,12 +34,10 @@ Matrix3 Matrix3::FromEulerAngles(float x, float y, float z)
     // from code written by Will Perone, located here:
     // https://github.com/MegaManSE/willperone/blob/master/Math/Matrix3.h
     
-    float cx = cosf(x);
-    float sx = sinf(x);
-    float cy = cosf(y);
-    float sy = sinf(y);
-    float cz = cosf(z);
-    float sz = sinf(z);
+    float cx, sx, cy, sy, cz, sz;
+    Trig::SinCos(x, sx, cx);
+    Trig::SinCos(y, sy, cy);
+    Trig::SinCos(z, sz, cz);
     float sxsy = sx * sy;
     float cxsy = cx * sy;
     
@@ -99,7 +99,7 @@ void Quaternion::ToAxisAngle(Vector3& axis, float& radians)
         axis.y = y * inverseLength;
         axis.z = y * inverseLength;
         
-        radians = 2.0f * acos(w);
+        radians = 2.0f * Trig::Acos(w);
     }
 }
 
@@ -113,13 +113,11 @@ Quaternion Quaternion::FromEulerAngles(float x, float y, float z)
     float halfy = 0.5f * y;
     float halfz = 0.5f * z;
     
-    float cos_x_2 = cosf(halfx);
-    float cos_y_2 = cosf(halfy);
-    float cos_z_2 = cosf(halfz);
-    
-    float sin_x_2 = sinf(halfx);
-    float sin_y_2 = sinf(halfy);
-    float sin_z_2 = sinf(halfz);
+    float cos_x_2, cos_y_2, cos_z_2;
+    float sin_x_2, sin_y_2, sin_z_2;
+    Trig::SinCos(halfx, sin_x_2, cos_x_2);
+    Trig::SinCos(halfy, sin_y_2, cos_y_2);
+    Trig::SinCos(halfz, sin_z_2, cos_z_2);
     
     float czcy2 = cos_z_2 * cos_y_2;
     float szsy2 = sin_z_2 * sin_y_2;
@@ -214,13 +212,13 @@ Quaternion Quaternion::Slerp(const Quaternion& q1, const Quaternion& q2, float t
     // one of the quaternions so we don't end up rotating more than 180 degrees.
     if (dot < 0.0f)
     {
-        float angle = acosf(-dot);
-        return (q1 * sinf(angle * (1 - t)) + -q2 * sinf(angle * t)) / sinf(angle);
+        float angle = Trig::Acos(-dot);
+        return (q1 * Trig::Sin(angle * (1 - t)) + -q2 * Trig::Sin(angle * t)) / Trig::Sin(angle);
     }
     else
     {
-        float angle = acosf(dot);
-        return (q1 * sinf(angle * (1 - t)) + q2 * sinf(angle * t)) / sinf(angle);
+        float angle = Trig::Acos(dot);
+        return (q1 * Trig::Sin(angle * (1 - t)) + q2 * Trig::Sin(angle * t)) / Trig::Sin(angle);
     }
 }
 
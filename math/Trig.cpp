@@ -1,8 +1,178 @@
 #include <math.h>
+#include "Math.hpp"
 #include "Trig.hpp"
 
+// Intervals per table, over the first quadrant for sine and over [0, 1] for
+// arctangent
+static const int TableSize = 1024;
+
+// pi/2 split in two so x - k * pi/2 stays accurate for large k
+static const float HalfPiHigh = 1.5703125f;
+static const float HalfPiLow = 4.83826794897e-4f;
+
+struct TrigTables
+{
+    float sine[TableSize + 2];
+    float arctangent[TableSize + 2];
+    
+    TrigTables()
+    {
+        // Series in double, using nothing but +, * and /, rounded to float
+        // once at the end
+        for (int i = 0; i <= TableSize + 1; ++i)
+        {
+            double x = (double)i * (1.5707963267948966 / TableSize);
+            double term = x;
+            double sum = x;
+            for (int n = 1; n < 12; ++n)
+            {
+                term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+                sum += term;
+            }
+            
+            sine[i] = (float)sum;
+        }
+        
+        for (int i = 0; i <= TableSize + 1; ++i)
+        {
+            // Halving the angle twice, atan(t) = 2 atan(t / (1 + sqrt(1 + t^2))),
+            // gets t under 0.42 where the series converges quickly
+            double t = (double)i / TableSize;
+            for (int halvings = 0; halvings < 2; ++halvings)
+            {
+                t = t / (1.0 + sqrt(1.0 + t * t));
+            }
+            
+            double term = t;
+            double sum = t;
+            for (int n = 1; n < 40; ++n)
+            {
+                term *= -t * t;
+                sum += term / (2.0 * n + 1.0);
+            }
+            
+            arctangent[i] = (float)(sum * 4.0);
+        }
+    }
+    
+    static const TrigTables& Get()
+    {
+        static TrigTables tables;
+        return tables;
+    }
+};
+
+static float Lookup(const float* table, float position)
+{
+    int index = (int)position;
+    float fraction = position - (float)index;
+    return table[index] + (table[index + 1] - table[index]) * fraction;
+}
+
+void Trig::TableSinCos(float x, float& sn, float& cs)
+{
+    const TrigTables& tables = TrigTables::Get();
+    
+    // Reduce to r in [0, pi/2) and which quadrant x is in
+    float quadrant = floorf(x * (2.0f / Math::Pi));
+    float r = (x - quadrant * HalfPiHigh) - quadrant * HalfPiLow;
+    
+    // x * 2/pi can round across a quadrant boundary, leaving r just below zero
+    if (r < 0.0f)
+    {
+        quadrant -= 1.0f;
+        r += Math::HalfPi;
+    }
+    r = r < 0.0f ? 0.0f : r;
+    
+    float position = r * (TableSize / Math::HalfPi);
+    position = position > (float)TableSize ? (float)TableSize : position;
+    
+    float s = Lookup(tables.sine, position);
+    float c = Lookup(tables.sine, (float)TableSize - position);
+    
+    switch ((long long)quadrant & 3)
+    {
+        case 0: sn = s; cs = c; break;
+        case 1: sn = c; cs = -s; break;
+        case 2: sn = -s; cs = -c; break;
+        default: sn = -c; cs = s; break;
+    }
+}
+
+float Trig::TableAtan2(float y, float x)
+{
+    const TrigTables& tables = TrigTables::Get();
+    
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    float largest = ax > ay ? ax : ay;
+    if (largest == 0.0f)
+    {
+        return 0.0f;
+    }
+    
+    float ratio = (ax > ay ? ay : ax) / largest;
+    float angle = Lookup(tables.arctangent, ratio * TableSize);
+    
+    angle = ay > ax ? Math::HalfPi - angle : angle;
+    angle = x < 0.0f ? Math::Pi - angle : angle;
+    return y < 0.0f ? -angle : angle;
+}
+
+float Trig::TableAcos(float x)
+{
+    x = x > 1.0f ? 1.0f : (x < -1.0f ? -1.0f : x);
+    return TableAtan2(sqrtf((1.0f - x) * (1.0f + x)), x);
+}
+
+#ifdef DETERMINISTIC_MATH
+
+void Trig::SinCos(float x, float& sn, float& cs)
+{
+    TableSinCos(x, sn, cs);
+}
+
+float Trig::Sin(float x)
+{
+    float sn, cs;
+    TableSinCos(x, sn, cs);
+    return sn;
+}
+
+float Trig::Cos(float x)
+{
+    float sn, cs;
+    TableSinCos(x, sn, cs);
+    return cs;
+}
+
+float Trig::Acos(float x)
+{
+    return TableAcos(x);
+}
+
+#else
+
 void Trig::SinCos(float x, float& sn, float& cs)
 {
     sn = sinf(x);
     cs = cosf(x);
 }
+
+float Trig::Sin(float x)
+{
+    return sinf(x);
+}
+
+float Trig::Cos(float x)
+{
+    return cosf(x);
+}
+
+float Trig::Acos(float x)
+{
+    return acosf(x);
+}
+
+#endif
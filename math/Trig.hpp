@@ -1,9 +1,23 @@
 #pragma once
 
 #include <stdio.h>
+#include "MathConfig.hpp"
 
 class Trig
 {
 public:
+    // These use the platform's libm, or the tables below in a
+    // DETERMINISTIC_MATH build.
     static void SinCos(float x, float& sn, float& cs);
+    static float Sin(float x);
+    static float Cos(float x);
+    static float Acos(float x);
+    
+    // Lookup table versions with linear interpolation, accurate to about
+    // 1e-6. The tables are built from series evaluated with plain IEEE
+    // arithmetic, so every platform gets the same values. Always available,
+    // so they can be compared against libm in any build.
+    static void TableSinCos(float x, float& sn, float& cs);
+    static float TableAtan2(float y, float x);
+    static float TableAcos(float x);
 };
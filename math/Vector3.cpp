@@ -153,3 +153,10 @@ Vector3 Vector3::GetLongest(const Vector3& first, const Vector3& second)
 
     return second;
 }
+
+Vector3 Vector3::Lerp(const Vector3& first, const Vector3& second, float t)
+{
+    return Vector3(first.x + (second.x - first.x) * t,
+                   first.y + (second.y - first.y) * t,
+                   first.z + (second.z - first.z) * t);
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <math.h>
+#include "MathConfig.hpp"
 #include <ostream>
 
 class Vector3
@@ -47,6 +48,7 @@ public:
     
     static Vector3 Reflect( const Vector3& first, const Vector3& second );
     static Vector3 GetLongest(const Vector3& first, const Vector3& second);
+    static Vector3 Lerp(const Vector3& first, const Vector3& second, float t);
     
     static const Vector3 Left;
     static const Vector3 Right;
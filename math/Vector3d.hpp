@@ -0,0 +1,56 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include "MathConfig.hpp"
+#include <ostream>
+#include "Vector3.hpp"
+
+// Double precision position for places far from the origin, where a float
+// Vector3 runs out of bits (a float's step is ~4mm at 32km, ~8mm past 65km).
+// Simulation data stays in floats relative to the scene's world origin, these
+// are for world space positions and for converting between the two.
+class Vector3d
+{
+public:
+    Vector3d(void) : x(0.0), y(0.0), z(0.0) {}
+    explicit Vector3d(double x, double y, double z) : x(x), y(y), z(z) {}
+    explicit Vector3d(const Vector3& v) : x(v.x), y(v.y), z(v.z) {}
+    
+    bool operator==(const Vector3d& rhs) const { return ( (x == rhs.x) && (y == rhs.y) && (z == rhs.z));}
+    bool operator!=(const Vector3d& rhs) const { return ( (x != rhs.x) || (y != rhs.y) || (z != rhs.z));}
+    Vector3d operator+(const Vector3d& rhs) const { return Vector3d(x + rhs.x, y + rhs.y, z + rhs.z); }
+    Vector3d operator-(const Vector3d& rhs) const { return Vector3d(x - rhs.x, y - rhs.y, z - rhs.z); }
+    Vector3d operator-(void) const { return Vector3d(-x, -y, -z); }
+    Vector3d operator*(double scalar) const { return Vector3d(x * scalar, y * scalar, z * scalar); }
+    void operator+=(const Vector3d& rhs) { x += rhs.x; y += rhs.y; z += rhs.z; }
+    void operator-=(const Vector3d& rhs) { x -= rhs.x; y -= rhs.y; z -= rhs.z; }
+    
+    friend std::ostream& operator<<(std::ostream& ofs, const Vector3d& rhs)
+    {
+        return ofs << "X: " << rhs.x << ", Y: " << rhs.y << ", Z: " << rhs.z;
+    }
+    
+    inline double Dot(const Vector3d& rhs) const { return (x * rhs.x + y * rhs.y + z * rhs.z); }
+    double Length(void) const { return sqrt( LengthSqr() ); }
+    inline double LengthSqr(void) const { return (x * x + y * y + z * z); }
+    
+    // Rounded to the nearest float, only sensible once made relative to
+    // something nearby
+    Vector3 ToFloat(void) const { return Vector3((float)x, (float)y, (float)z); }
+    
+    // (positions[i] - origin).ToFloat() for a whole array
+    static void ToRelative(const Vector3d* positions, size_t count, const Vector3d& origin, Vector3* out)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i].x = (float)(positions[i].x - origin.x);
+            out[i].y = (float)(positions[i].y - origin.y);
+            out[i].z = (float)(positions[i].z - origin.z);
+        }
+    }
+    
+    double x;
+    double y;
+    double z;
+};
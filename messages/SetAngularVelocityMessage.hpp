@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../core/BaseMessage.hpp"
+#include "../math/Vector3.hpp"
+
+using namespace Core;
+
+class SetAngularVelocityMessage : public BaseMessage
+{
+public:
+    SetAngularVelocityMessage(int targetObjectID, const Vector3& angularVelocity) :
+        BaseMessage(targetObjectID, MessageType::SetAngularVelocity, true),
+        angularVelocity(angularVelocity)
+    {
+    }
+    
+    BaseMessage* Clone() const override { return new SetAngularVelocityMessage(*this); }
+    void CopyFrom(const BaseMessage& other) override { *this = static_cast<const SetAngularVelocityMessage&>(other); }
+    
+    Vector3 angularVelocity;
+};
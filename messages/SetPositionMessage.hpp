@@ -9,11 +9,14 @@ class SetPositionMessage : public BaseMessage
 {
 public:
     SetPositionMessage(int targetObjectID, const Vector3& position) :
-        BaseMessage(targetObjectID, MessageType::SetPosition),
+        BaseMessage(targetObjectID, MessageType::SetPosition, true),
         position(position)
     {
         
     }
     
+    BaseMessage* Clone() const override { return new SetPositionMessage(*this); }
+    void CopyFrom(const BaseMessage& other) override { *this = static_cast<const SetPositionMessage&>(other); }
+    
     Vector3 position;
 };
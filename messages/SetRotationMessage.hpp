@@ -9,10 +9,13 @@ class SetRotationMessage : public BaseMessage
 {
 public:
     SetRotationMessage(int targetObjectID, const Quaternion& rotation) :
-        BaseMessage(targetObjectID, MessageType::SetRotation),
+        BaseMessage(targetObjectID, MessageType::SetRotation, true),
         rotation(rotation)
     {
     }
     
+    BaseMessage* Clone() const override { return new SetRotationMessage(*this); }
+    void CopyFrom(const BaseMessage& other) override { *this = static_cast<const SetRotationMessage&>(other); }
+    
     Quaternion rotation;
 };
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../core/BaseMessage.hpp"
+#include "../math/Vector3.hpp"
+
+using namespace Core;
+
+class SetVelocityMessage : public BaseMessage
+{
+public:
+    SetVelocityMessage(int targetObjectID, const Vector3& velocity) :
+        BaseMessage(targetObjectID, MessageType::SetVelocity, true),
+        velocity(velocity)
+    {
+    }
+    
+    BaseMessage* Clone() const override { return new SetVelocityMessage(*this); }
+    void CopyFrom(const BaseMessage& other) override { *this = static_cast<const SetVelocityMessage&>(other); }
+    
+    Vector3 velocity;
+};
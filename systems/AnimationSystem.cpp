@@ -0,0 +1,173 @@
+#include <cmath>
+#include <unordered_map>
+#include "AnimationSystem.hpp"
+#include "../core/SceneManager.hpp"
+#include "../core/ThreadPool.hpp"
+
+using namespace Core;
+
+AnimationSystem::AnimationSystem(ThreadPool* threadPool) :
+    threadPool(threadPool != nullptr ? threadPool : &ThreadPool::GetDefault())
+{
+}
+
+void AnimationSystem::Play(int objectID, std::shared_ptr<const AnimationClip> clip, uint32_t track, float startSeconds, bool loop)
+{
+    if (track >= clip->GetTrackCount())
+    {
+        throw "Animation track out of range";
+    }
+    
+    Player player{ objectID, std::move(clip), track, startSeconds, loop, AnimationCursor(), UnboundSlot };
+    auto it = playerIndexByObject.find(objectID);
+    if (it != playerIndexByObject.end())
+    {
+        // Same object, so whatever slot the old player had still holds
+        player.storageIndex = players[it->second].storageIndex;
+        players[it->second] = std::move(player);
+    }
+    else
+    {
+        // The slot is looked up on the next update, when the layout is known
+        playerIndexByObject[objectID] = players.size();
+        players.push_back(std::move(player));
+        ++unboundCount;
+    }
+}
+
+bool AnimationSystem::Stop(int objectID)
+{
+    auto it = playerIndexByObject.find(objectID);
+    if (it == playerIndexByObject.end())
+    {
+        return false;
+    }
+    
+    // Swap the last player into the hole
+    size_t index = it->second;
+    size_t last = players.size() - 1;
+    playerIndexByObject.erase(it);
+    if (players[index].storageIndex == UnboundSlot)
+    {
+        --unboundCount;
+    }
+    
+    if (index != last)
+    {
+        players[index] = std::move(players[last]);
+        playerIndexByObject[players[index].objectID] = index;
+    }
+    
+    players.pop_back();
+    return true;
+}
+
+void AnimationSystem::Update(SceneManager& sceneMgr, float deltaSeconds)
+{
+    if (cachedLayoutVersion != sceneMgr.GetTransformLayoutVersion())
+    {
+        Rebind(sceneMgr);
+    }
+    else if (unboundCount != 0)
+    {
+        BindNewPlayers(sceneMgr);
+    }
+    
+    TransformStorage& storage = sceneMgr.GetTransformStorage();
+    TransformBuffer& transforms = storage.transforms;
+    uint64_t writeVersion = storage.BeginWrite();
+    const Vector3d origin = sceneMgr.GetWorldOrigin();
+    
+    threadPool->ParallelFor(players.size(), chunkSize, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            Player& player = players[i];
+            
+            float duration = player.clip->GetDuration();
+            player.time += deltaSeconds;
+            if (player.time > duration)
+            {
+                player.time = player.loop && duration > 0.0f ? fmodf(player.time, duration) : duration;
+            }
+            
+            Vector3 position;
+            Quaternion rotation;
+            player.clip->Sample(player.track, player.time, player.cursor, position, rotation);
+            
+            // Clips are in world space, so they're relative to wherever the
+            // scene's origin has been rebased to
+            position = (Vector3d(position) - origin).ToFloat();
+            
+            size_t slot = player.storageIndex;
+            transforms.px[slot] = position.x;
+            transforms.py[slot] = position.y;
+            transforms.pz[slot] = position.z;
+            transforms.rw[slot] = rotation.w;
+            transforms.rx[slot] = rotation.x;
+            transforms.ry[slot] = rotation.y;
+            transforms.rz[slot] = rotation.z;
+            storage.MarkWritten(slot, writeVersion);
+        }
+    });
+}
+
+void AnimationSystem::Rebind(const SceneManager& sceneMgr)
+{
+    const TransformBuffer& transforms = sceneMgr.GetTransformStorage().GetTransforms();
+    
+    std::unordered_map<int, size_t> slots;
+    slots.reserve(transforms.GetCount());
+    for (size_t i = 0; i < transforms.GetCount(); ++i)
+    {
+        slots.emplace(transforms.objectIDs[i], i);
+    }
+    
+    size_t kept = 0;
+    for (Player& player : players)
+    {
+        auto it = slots.find(player.objectID);
+        if (it != slots.end())
+        {
+            player.storageIndex = it->second;
+            players[kept++] = std::move(player);
+        }
+    }
+    
+    // Dropping players moved the rest down
+    if (kept != players.size())
+    {
+        players.resize(kept);
+        playerIndexByObject.clear();
+        for (size_t i = 0; i < players.size(); ++i)
+        {
+            playerIndexByObject[players[i].objectID] = i;
+        }
+    }
+    
+    unboundCount = 0;
+    cachedLayoutVersion = sceneMgr.GetTransformLayoutVersion();
+}
+
+void AnimationSystem::BindNewPlayers(const SceneManager& sceneMgr)
+{
+    size_t i = 0;
+    while (i < players.size() && unboundCount != 0)
+    {
+        Player& player = players[i];
+        if (player.storageIndex != UnboundSlot)
+        {
+            ++i;
+        }
+        else if (sceneMgr.FindTransformSlot(player.objectID, player.storageIndex))
+        {
+            --unboundCount;
+            ++i;
+        }
+        else
+        {
+            // Swaps the last player into this index, so look at it again
+            Stop(player.objectID);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "../core/AnimationClip.hpp"
+
+namespace Core
+{
+    class SceneManager;
+    class ThreadPool;
+}
+
+// Plays AnimationClip tracks onto objects' transforms. Every playing track is
+// sampled each update, split into chunks across the thread pool, and written
+// straight into the scene's TransformStorage the same way IntegrationSystem
+// writes velocities, so there's no message per animated object. Clip positions
+// are world space, and are moved into the scene's local space as they're
+// written, so animated objects stay put when the scene's origin is rebased.
+class AnimationSystem
+{
+public:
+    explicit AnimationSystem(Core::ThreadPool* threadPool = nullptr);
+    
+    // Starts a track on the object, replacing anything already playing on it.
+    // Objects without a transform in the scene are dropped at the next Update().
+    void Play(int objectID, std::shared_ptr<const Core::AnimationClip> clip, uint32_t track,
+              float startSeconds = 0.0f, bool loop = true);
+    
+    // Returns false if nothing was playing on the object
+    bool Stop(int objectID);
+    
+    // Advances every player by deltaSeconds and writes the sampled transforms
+    void Update(Core::SceneManager& sceneMgr, float deltaSeconds);
+    
+    size_t GetPlayerCount() const { return players.size(); }
+    
+    void SetChunkSize(size_t players) { chunkSize = players; }
+    
+private:
+    struct Player
+    {
+        int objectID;
+        std::shared_ptr<const Core::AnimationClip> clip;
+        uint32_t track;
+        float time;
+        bool loop;
+        Core::AnimationCursor cursor;
+        size_t storageIndex;
+    };
+    
+    // Players started since the last update don't have a slot yet
+    static const size_t UnboundSlot = SIZE_MAX;
+    
+    // Maps players to their transform's current storage slot
+    void Rebind(const Core::SceneManager& sceneMgr);
+    
+    // Finds slots for just the players that don't have one, for when the
+    // layout hasn't changed
+    void BindNewPlayers(const Core::SceneManager& sceneMgr);
+    
+private:
+    Core::ThreadPool* threadPool;
+    size_t chunkSize = 1024;
+    
+    uint64_t cachedLayoutVersion = UINT64_MAX;
+    std::vector<Player> players;
+    std::unordered_map<int, size_t> playerIndexByObject;
+    size_t unboundCount = 0;
+};
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cmath>
+#include "BroadPhase.hpp"
+#include "../components/BoundsComponent.hpp"
+#include "../core/SceneManager.hpp"
+#include "../core/ThreadPool.hpp"
+
+using namespace Core;
+
+BroadPhase::BroadPhase(ThreadPool* threadPool) :
+    threadPool(threadPool != nullptr ? threadPool : &ThreadPool::GetDefault())
+{
+}
+
+void BroadPhase::Update(const SceneManager& sceneMgr)
+{
+    if (sceneMgr.GetComponentVersion() != cachedComponentVersion ||
+        sceneMgr.GetTransformLayoutVersion() != cachedLayoutVersion)
+    {
+        Rebuild(sceneMgr);
+    }
+    
+    ComputeWorldBounds(sceneMgr);
+    SortAxis();
+    Sweep();
+}
+
+void BroadPhase::Rebuild(const SceneManager& sceneMgr)
+{
+    const TransformStorage& storage = sceneMgr.GetTransformStorage();
+    
+    previousIDs.swap(objectIDs);
+    previousOrder.swap(order);
+    
+    objectIDs.clear();
+    storageIndices.clear();
+    bounds.clear();
+    
+    for (size_t i = 0; i < storage.GetCount(); ++i)
+    {
+        const Component* component = storage.objects[i]->GetComponent(ComponentType::Bounds);
+        if (component != nullptr)
+        {
+            objectIDs.push_back(storage.transforms.objectIDs[i]);
+            storageIndices.push_back(i);
+            bounds.push_back(static_cast<const BoundsComponent*>(component));
+        }
+    }
+    
+    size_t count = objectIDs.size();
+    minX.resize(count);
+    maxX.resize(count);
+    minY.resize(count);
+    maxY.resize(count);
+    minZ.resize(count);
+    maxZ.resize(count);
+    
+    // Most entries survive a layout change, they've just moved slot. Keep
+    // them in their old sorted order so the insertion sort still has little
+    // to do, and put new entries at the end for it to slot in. IDs are handed
+    // out in sequence so a flat table covers them, unless the scene has
+    // become so sparse that a full sort is cheaper anyway.
+    order.clear();
+    if (count != 0 && !previousOrder.empty())
+    {
+        auto range = std::minmax_element(objectIDs.begin(), objectIDs.end());
+        int firstID = *range.first;
+        size_t idRange = static_cast<size_t>(*range.second - firstID) + 1;
+        if (idRange <= count * 4)
+        {
+            entryByID.assign(idRange, UINT32_MAX);
+            for (size_t i = 0; i < count; ++i)
+            {
+                entryByID[objectIDs[i] - firstID] = static_cast<uint32_t>(i);
+            }
+            
+            for (uint32_t previous : previousOrder)
+            {
+                size_t offset = static_cast<size_t>(previousIDs[previous] - firstID);
+                if (previousIDs[previous] >= firstID && offset < idRange && entryByID[offset] != UINT32_MAX)
+                {
+                    order.push_back(entryByID[offset]);
+                    entryByID[offset] = UINT32_MAX;   // Taken, whatever's left is new
+                }
+            }
+            
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (entryByID[objectIDs[i] - firstID] != UINT32_MAX)
+                {
+                    order.push_back(static_cast<uint32_t>(i));
+                }
+            }
+        }
+    }
+    
+    orderIsFresh = order.empty();
+    if (orderIsFresh)
+    {
+        order.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            order[i] = static_cast<uint32_t>(i);
+        }
+    }
+    
+    cachedComponentVersion = sceneMgr.GetComponentVersion();
+    cachedLayoutVersion = sceneMgr.GetTransformLayoutVersion();
+}
+
+void BroadPhase::ComputeWorldBounds(const SceneManager& sceneMgr)
+{
+    const TransformBuffer& transforms = sceneMgr.GetTransformStorage().GetTransforms();
+    
+    threadPool->ParallelFor(objectIDs.size(), chunkSize, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            size_t slot = storageIndices[i];
+            const Vector3& center = bounds[i]->GetCenter();
+            const Vector3& extents = bounds[i]->GetHalfExtents();
+            
+            float w = transforms.rw[slot], x = transforms.rx[slot], y = transforms.ry[slot], z = transforms.rz[slot];
+            
+            // Rotation matrix for the quaternion
+            float r00 = 1.0f - 2.0f * (y * y + z * z), r01 = 2.0f * (x * y - w * z),        r02 = 2.0f * (x * z + w * y);
+            float r10 = 2.0f * (x * y + w * z),        r11 = 1.0f - 2.0f * (x * x + z * z), r12 = 2.0f * (y * z - w * x);
+            float r20 = 2.0f * (x * z - w * y),        r21 = 2.0f * (y * z + w * x),        r22 = 1.0f - 2.0f * (x * x + y * y);
+            
+            float cx = transforms.px[slot] + r00 * center.x + r01 * center.y + r02 * center.z;
+            float cy = transforms.py[slot] + r10 * center.x + r11 * center.y + r12 * center.z;
+            float cz = transforms.pz[slot] + r20 * center.x + r21 * center.y + r22 * center.z;
+            
+            // Extents of the rotated box projected back onto the world axes
+            float ex = std::fabs(r00) * extents.x + std::fabs(r01) * extents.y + std::fabs(r02) * extents.z;
+            float ey = std::fabs(r10) * extents.x + std::fabs(r11) * extents.y + std::fabs(r12) * extents.z;
+            float ez = std::fabs(r20) * extents.x + std::fabs(r21) * extents.y + std::fabs(r22) * extents.z;
+            
+            minX[i] = cx - ex;
+            maxX[i] = cx + ex;
+            minY[i] = cy - ey;
+            maxY[i] = cy + ey;
+            minZ[i] = cz - ez;
+            maxZ[i] = cz + ez;
+        }
+    });
+}
+
+void BroadPhase::SortAxis()
+{
+    const size_t count = order.size();
+    
+    // Insertion sort, cheap when the previous order is nearly right. If it
+    // turns out to be badly out of order (teleports, lots of new entries)
+    // bail out to a full sort instead of going quadratic. With no previous
+    // order at all there's no point trying.
+    size_t shifts = 0;
+    const size_t shiftBudget = count * 8 + 64;
+    for (size_t i = 1; !orderIsFresh && i < count && shifts <= shiftBudget; ++i)
+    {
+        uint32_t entry = order[i];
+        float key = minX[entry];
+        size_t j = i;
+        while (j > 0 && minX[order[j - 1]] > key)
+        {
+            order[j] = order[j - 1];
+            --j;
+            ++shifts;
+        }
+        order[j] = entry;
+    }
+    
+    if (orderIsFresh || shifts > shiftBudget)
+    {
+        std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return minX[a] < minX[b]; });
+        orderIsFresh = false;
+    }
+    
+    sortedIDs.resize(count);
+    sortedMinX.resize(count);
+    sortedMaxX.resize(count);
+    sortedMinY.resize(count);
+    sortedMaxY.resize(count);
+    sortedMinZ.resize(count);
+    sortedMaxZ.resize(count);
+    
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t entry = order[i];
+        sortedIDs[i] = objectIDs[entry];
+        sortedMinX[i] = minX[entry];
+        sortedMaxX[i] = maxX[entry];
+        sortedMinY[i] = minY[entry];
+        sortedMaxY[i] = maxY[entry];
+        sortedMinZ[i] = minZ[entry];
+        sortedMaxZ[i] = maxZ[entry];
+    }
+}
+
+void BroadPhase::Sweep()
+{
+    const size_t count = sortedIDs.size();
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    
+    if (chunkPairs.size() < chunkCount)
+    {
+        chunkPairs.resize(chunkCount);
+    }
+    
+    // Each segment owns the boxes that start in it, but its sweep can run
+    // past the end of the segment to find their partners.
+    threadPool->ParallelFor(count, chunkSize, [&](size_t begin, size_t end)
+    {
+        // ParallelFor may hand back the whole range at once when it runs inline
+        for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += chunkSize)
+        {
+            size_t chunkEnd = std::min(chunkBegin + chunkSize, end);
+            std::vector<Pair>& out = chunkPairs[chunkBegin / chunkSize];
+            out.clear();
+            
+            for (size_t i = chunkBegin; i < chunkEnd; ++i)
+            {
+                const float maxXi = sortedMaxX[i];
+                for (size_t j = i + 1; j < count && sortedMinX[j] <= maxXi; ++j)
+                {
+                    if (sortedMinY[j] <= sortedMaxY[i] && sortedMaxY[j] >= sortedMinY[i] &&
+                        sortedMinZ[j] <= sortedMaxZ[i] && sortedMaxZ[j] >= sortedMinZ[i])
+                    {
+                        int a = sortedIDs[i];
+                        int b = sortedIDs[j];
+                        out.push_back(a < b ? Pair{ a, b } : Pair{ b, a });
+                    }
+                }
+            }
+        }
+    });
+    
+    pairs.clear();
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        pairs.insert(pairs.end(), chunkPairs[chunk].begin(), chunkPairs[chunk].end());
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class BoundsComponent;
+
+namespace Core
+{
+    class SceneManager;
+    class ThreadPool;
+}
+
+// Sort-and-sweep broad phase over every object with a BoundsComponent and a
+// TransformComponent. Boxes are kept sorted by their minimum X from one step
+// to the next, and since objects only move a little per step that order is
+// nearly right already, so an insertion sort brings it up to date in close to
+// linear time. The sweep is split into segments of the sorted axis that run
+// on the thread pool.
+class BroadPhase
+{
+public:
+    struct Pair
+    {
+        int objectA;    // Always the lower of the two IDs
+        int objectB;
+    };
+    
+    explicit BroadPhase(Core::ThreadPool* threadPool = nullptr);
+    
+    // Recomputes world bounds and refills the overlapping pair list
+    void Update(const Core::SceneManager& sceneMgr);
+    
+    // Reused between updates, so hold on to it only until the next Update()
+    const std::vector<Pair>& GetPairs() const { return pairs; }
+    
+    size_t GetBoundsCount() const { return objectIDs.size(); }
+    
+    void SetChunkSize(size_t entries) { chunkSize = entries; }
+    
+private:
+    void Rebuild(const Core::SceneManager& sceneMgr);
+    void ComputeWorldBounds(const Core::SceneManager& sceneMgr);
+    void SortAxis();
+    void Sweep();
+    
+private:
+    Core::ThreadPool* threadPool;
+    size_t chunkSize = 2048;
+    
+    uint64_t cachedComponentVersion = UINT64_MAX;
+    uint64_t cachedLayoutVersion = UINT64_MAX;
+    
+    // One entry per bounded object, in TransformStorage order
+    std::vector<int> objectIDs;
+    std::vector<size_t> storageIndices;
+    std::vector<const BoundsComponent*> bounds;
+    std::vector<float> minX, maxX, minY, maxY, minZ, maxZ;
+    
+    // Entries sorted by minX, carried over between updates. A rebuild carries
+    // the order over by object ID, and only starts again when nothing
+    // could be carried over.
+    std::vector<uint32_t> order;
+    bool orderIsFresh = true;
+    
+    // Rebuild scratch
+    std::vector<uint32_t> entryByID;
+    std::vector<uint32_t> previousOrder;
+    std::vector<int> previousIDs;
+    
+    // World bounds gathered into sorted order so the sweep reads linearly
+    std::vector<int> sortedIDs;
+    std::vector<float> sortedMinX, sortedMaxX, sortedMinY, sortedMaxY, sortedMinZ, sortedMaxZ;
+    
+    std::vector<std::vector<Pair>> chunkPairs;
+    std::vector<Pair> pairs;
+};
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "CullingSystem.hpp"
+#include "../core/SceneManager.hpp"
+#include "../core/ThreadPool.hpp"
+#include "../math/Math.hpp"
+
+using namespace Core;
+
+// Masks are built for this many objects at a time so they stay in L1
+static const size_t CullingBlockSize = 256;
+
+static CullingPlane MakePlane(const Vector3& normal, const Vector3& pointOnPlane)
+{
+    return CullingPlane{ normal.x, normal.y, normal.z, -normal.Dot(pointOnPlane) };
+}
+
+CullingFrustum CullingFrustum::FromPerspective(const Vector3& position, const Matrix3& orientation,
+                                               float verticalFovRadians, float aspect,
+                                               float nearDistance, float farDistance)
+{
+    Vector3 forward = orientation.GetRollAxis();
+    Vector3 up = orientation.GetYawAxis();
+    Vector3 right = orientation.GetPitchAxis();
+    
+    float halfY = verticalFovRadians * 0.5f;
+    float halfX = atanf(tanf(halfY) * aspect);
+    float sinX = sinf(halfX), cosX = cosf(halfX);
+    float sinY = sinf(halfY), cosY = cosf(halfY);
+    
+    // Side plane normals lean in from the forward axis by the half angle
+    CullingFrustum frustum;
+    frustum.planes[0] = MakePlane(forward, position + forward * nearDistance);
+    frustum.planes[1] = MakePlane(-forward, position + forward * farDistance);
+    frustum.planes[2] = MakePlane(forward * sinX + right * cosX, position);
+    frustum.planes[3] = MakePlane(forward * sinX - right * cosX, position);
+    frustum.planes[4] = MakePlane(forward * sinY + up * cosY, position);
+    frustum.planes[5] = MakePlane(forward * sinY - up * cosY, position);
+    return frustum;
+}
+
+CullingFrustum CullingFrustum::Everything()
+{
+    CullingFrustum frustum;
+    for (auto& plane : frustum.planes)
+    {
+        plane = CullingPlane{ 0.0f, 0.0f, 0.0f, FLT_MAX };
+    }
+    
+    return frustum;
+}
+
+CullingSystem::CullingSystem(ThreadPool* threadPool) :
+    threadPool(threadPool != nullptr ? threadPool : &ThreadPool::GetDefault())
+{
+}
+
+void CullingSystem::Cull(const SceneManager& sceneMgr, std::vector<CullingView>& views)
+{
+    const TransformBuffer& transforms = sceneMgr.GetTransformStorage().GetTransforms();
+    const size_t count = transforms.GetCount();
+    
+    threadPool->ParallelFor(views.size(), 1, [&](size_t begin, size_t end)
+    {
+        for (size_t v = begin; v < end; ++v)
+        {
+            CullingView& view = views[v];
+            view.visible.resize(count);
+            size_t passed = count > 0 ? CullSpheres(view, transforms.px.data(), transforms.py.data(), transforms.pz.data(), count, view.visible.data()) : 0;
+            view.visible.resize(passed);
+        }
+    });
+}
+
+// Writes the index of every set mask entry, without branching on the mask
+static size_t Compact(const uint8_t* mask, size_t base, size_t count, uint32_t* out)
+{
+    size_t written = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[written] = static_cast<uint32_t>(base + i);
+        written += mask[i];
+    }
+    
+    return written;
+}
+
+size_t CullingSystem::CullSpheres(const CullingView& view,
+                                  const float* __restrict x, const float* __restrict y, const float* __restrict z,
+                                  size_t count, uint32_t* out)
+{
+    const float radius = view.objectRadius;
+    const CullingPlane* planes = view.frustum.planes;
+    
+    // Disabled tests get limits that everything passes, so the loop below
+    // always runs every test.
+    const float px = view.position.x, py = view.position.y, pz = view.position.z;
+    const float reach = view.maxDistance >= 0.0f ? view.maxDistance + radius : FLT_MAX;
+    const float maxDistanceSqr = reach < 1.0e18f ? reach * reach : FLT_MAX;
+    
+    Vector3 direction = view.coneDirection;
+    direction.Unitize();
+    const float coneCos = view.coneHalfAngle >= 0.0f ? cosf(std::min(view.coneHalfAngle, Math::Pi)) : -1.0f;
+    const float coneCosSqr = coneCos * coneCos;
+    const bool wideCone = coneCos < 0.0f;
+    
+    uint8_t mask[CullingBlockSize];
+    size_t written = 0;
+    
+    for (size_t base = 0; base < count; base += CullingBlockSize)
+    {
+        const size_t blockCount = count - base < CullingBlockSize ? count - base : CullingBlockSize;
+        const float* bx = x + base;
+        const float* by = y + base;
+        const float* bz = z + base;
+        
+        for (size_t i = 0; i < blockCount; ++i)
+        {
+            bool inside = true;
+            for (int p = 0; p < 6; ++p)
+            {
+                inside &= planes[p].nx * bx[i] + planes[p].ny * by[i] + planes[p].nz * bz[i] + planes[p].d >= -radius;
+            }
+            
+            float dx = bx[i] - px;
+            float dy = by[i] - py;
+            float dz = bz[i] - pz;
+            float distanceSqr = dx * dx + dy * dy + dz * dz;
+            inside &= distanceSqr <= maxDistanceSqr;
+            
+            // dot >= cos * |d| without the sqrt. Squaring loses the signs, so
+            // a cone wider than 90 degrees (cos < 0) takes everything ahead
+            // plus whatever behind is still within the angle. A disabled test
+            // is a 180 degree cone, which passes everything.
+            float along = dx * direction.x + dy * direction.y + dz * direction.z;
+            bool inNarrowCone = along >= 0.0f && along * along >= coneCosSqr * distanceSqr;
+            bool inWideCone = along >= 0.0f || along * along <= coneCosSqr * distanceSqr;
+            inside &= wideCone ? inWideCone : inNarrowCone;
+            
+            mask[i] = inside;
+        }
+        
+        written += Compact(mask, base, blockCount, out + written);
+    }
+    
+    return written;
+}
+
+size_t CullingSystem::CullBoxes(const CullingFrustum& frustum,
+                                const float* __restrict minX, const float* __restrict minY, const float* __restrict minZ,
+                                const float* __restrict maxX, const float* __restrict maxY, const float* __restrict maxZ,
+                                size_t count, uint32_t* out)
+{
+    const CullingPlane* planes = frustum.planes;
+    
+    uint8_t mask[CullingBlockSize];
+    size_t written = 0;
+    
+    for (size_t base = 0; base < count; base += CullingBlockSize)
+    {
+        const size_t blockCount = count - base < CullingBlockSize ? count - base : CullingBlockSize;
+        
+        for (size_t i = 0; i < blockCount; ++i)
+        {
+            size_t k = base + i;
+            float cx = (minX[k] + maxX[k]) * 0.5f, ex = (maxX[k] - minX[k]) * 0.5f;
+            float cy = (minY[k] + maxY[k]) * 0.5f, ey = (maxY[k] - minY[k]) * 0.5f;
+            float cz = (minZ[k] + maxZ[k]) * 0.5f, ez = (maxZ[k] - minZ[k]) * 0.5f;
+            
+            // A box is outside a plane only if even its corner furthest along
+            // the normal is behind it.
+            bool inside = true;
+            for (int p = 0; p < 6; ++p)
+            {
+                float distance = planes[p].nx * cx + planes[p].ny * cy + planes[p].nz * cz + planes[p].d;
+                float projected = std::fabs(planes[p].nx) * ex + std::fabs(planes[p].ny) * ey + std::fabs(planes[p].nz) * ez;
+                inside &= distance + projected >= 0.0f;
+            }
+            
+            mask[i] = inside;
+        }
+        
+        written += Compact(mask, base, blockCount, out + written);
+    }
+    
+    return written;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../math/Matrix3.hpp"
+#include "../math/Vector3.hpp"
+
+namespace Core
+{
+    class SceneManager;
+    class ThreadPool;
+}
+
+// Plane in the form normal.Dot(point) + d, positive on the inside
+struct CullingPlane
+{
+    float nx, ny, nz, d;
+};
+
+struct CullingFrustum
+{
+    CullingPlane planes[6];
+    
+    // Builds the frustum for a viewer at 'position' looking down the
+    // orientation's roll axis, with its yaw axis as up.
+    static CullingFrustum FromPerspective(const Vector3& position, const Matrix3& orientation,
+                                          float verticalFovRadians, float aspect,
+                                          float nearDistance, float farDistance);
+    
+    // A frustum that everything passes, for views that only use distance or cone tests
+    static CullingFrustum Everything();
+};
+
+// One viewer (camera, client, AI sensor...) and the set of objects relevant to it
+struct CullingView
+{
+    CullingFrustum frustum = CullingFrustum::Everything();
+    
+    Vector3 position;
+    float maxDistance = -1.0f;          // Negative disables the distance test
+    
+    Vector3 coneDirection = Vector3::Forward;
+    float coneHalfAngle = -1.0f;        // Negative disables the cone test, radians otherwise
+    
+    // Objects are treated as spheres of this radius around their position
+    float objectRadius = 0.0f;
+    
+    // Output: TransformStorage slots that passed every enabled test, in slot order
+    std::vector<uint32_t> visible;
+};
+
+// Batch culling of every transform in a scene against any number of views.
+// Each view is culled as its own task on the thread pool. Within a view the
+// tests are folded into one branch-free mask per object, so the kernel
+// vectorizes, and the mask is then compacted into the index list.
+class CullingSystem
+{
+public:
+    explicit CullingSystem(Core::ThreadPool* threadPool = nullptr);
+    
+    void Cull(const Core::SceneManager& sceneMgr, std::vector<CullingView>& views);
+    
+    // Kernels over raw SoA arrays. Both write the indices that pass to 'out',
+    // which must have room for 'count' entries, and return how many passed.
+    static size_t CullSpheres(const CullingView& view,
+                              const float* x, const float* y, const float* z,
+                              size_t count, uint32_t* out);
+    
+    static size_t CullBoxes(const CullingFrustum& frustum,
+                            const float* minX, const float* minY, const float* minZ,
+                            const float* maxX, const float* maxY, const float* maxZ,
+                            size_t count, uint32_t* out);
+    
+private:
+    Core::ThreadPool* threadPool;
+};
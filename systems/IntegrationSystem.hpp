@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Core
+{
+    class SceneManager;
+    class ThreadPool;
+}
+
+// Applies VelocityComponent and AngularVelocityComponent to every transform
+// in a scene in one streaming pass over the scene's TransformStorage arrays,
+// instead of sending a SetPosition/SetRotation message per object.
+//
+// Rotations are advanced by the quaternion exponential of the angular
+// velocity, which drifts slowly away from unit length, so they're
+// renormalized every few steps rather than every step.
+class IntegrationSystem
+{
+public:
+    explicit IntegrationSystem(Core::ThreadPool* threadPool = nullptr);
+    
+    void Integrate(Core::SceneManager& sceneMgr, float deltaSeconds);
+    
+    // 1 renormalizes every step, 0 never does
+    void SetRenormalizeInterval(int steps) { renormalizeInterval = steps; }
+    void SetChunkSize(size_t transforms) { chunkSize = transforms; }
+    
+    // Kernels over raw SoA arrays, exposed so other systems and benchmarks
+    // can run them on their own data.
+    static void IntegrateLinear(float* px, float* py, float* pz,
+                                const float* vx, const float* vy, const float* vz,
+                                size_t count, float deltaSeconds);
+    
+    static void IntegrateAngular(float* rw, float* rx, float* ry, float* rz,
+                                 const float* wx, const float* wy, const float* wz,
+                                 size_t count, float deltaSeconds);
+    
+    static void Renormalize(float* rw, float* rx, float* ry, float* rz, size_t count);
+    
+private:
+    Core::ThreadPool* threadPool;
+    size_t chunkSize = 4096;
+    int renormalizeInterval = 8;
+    uint64_t stepCount = 0;
+};
@@ -0,0 +1,181 @@
+#include "HardwareCounters.hpp"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+static int OpenCounter(uint32_t type, uint64_t config, int groupLeader)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    
+    // This thread, any CPU
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupLeader, 0));
+}
+#endif
+
+HardwareCounters::HardwareCounters()
+{
+    for (int& fd : fds)
+    {
+        fd = -1;
+    }
+    
+#ifdef __linux__
+    const uint64_t l1Miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    
+    const struct
+    {
+        uint32_t type;
+        uint64_t config;
+    } events[CounterCount] =
+    {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, l1Miss },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    };
+    
+    // The first counter that opens leads the group, the rest join it
+    for (int i = 0; i < CounterCount; ++i)
+    {
+        fds[i] = OpenCounter(events[i].type, events[i].config, leader);
+        if (fds[i] < 0)
+        {
+            continue;
+        }
+        
+        if (leader < 0)
+        {
+            leader = fds[i];
+        }
+        readOrder[groupSize++] = i;
+    }
+#endif
+}
+
+HardwareCounters::~HardwareCounters()
+{
+#ifdef __linux__
+    for (int fd : fds)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+#endif
+}
+
+bool HardwareCounters::IsAvailable() const
+{
+    for (int fd : fds)
+    {
+        if (fd >= 0)
+        {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+HardwareCounters::Values HardwareCounters::Read() const
+{
+    Values values;
+    
+#ifdef __linux__
+    if (leader < 0)
+    {
+        return values;
+    }
+    
+    // nr, time enabled, time running, then one value per member
+    uint64_t data[3 + CounterCount];
+    const ssize_t expected = static_cast<ssize_t>((3 + groupSize) * sizeof(uint64_t));
+    if (read(leader, data, sizeof(data)) != expected || data[0] != static_cast<uint64_t>(groupSize))
+    {
+        return values;
+    }
+    
+    values.timeEnabled = data[1];
+    values.timeRunning = data[2];
+    for (int i = 0; i < groupSize; ++i)
+    {
+        values.counts[readOrder[i]] = data[3 + i];
+        values.available[readOrder[i]] = true;
+    }
+#endif
+    
+    return values;
+}
+
+const char* HardwareCounters::GetName(Counter counter)
+{
+    switch (counter)
+    {
+        case Cycles: return "cycles";
+        case Instructions: return "instructions";
+        case L1DataMisses: return "L1D misses";
+        case LastLevelCacheMisses: return "LLC misses";
+        case BranchMisses: return "branch misses";
+        default: return "unknown";
+    }
+}
+
+double HardwareCounters::Values::GetIPC() const
+{
+    if (!Has(Cycles) || !Has(Instructions) || counts[Cycles] == 0)
+    {
+        return 0.0;
+    }
+    
+    return static_cast<double>(counts[Instructions]) / counts[Cycles];
+}
+
+double HardwareCounters::Values::GetRate(Counter counter, uint64_t per) const
+{
+    if (!Has(counter) || per == 0)
+    {
+        return 0.0;
+    }
+    
+    return static_cast<double>(counts[counter]) / per;
+}
+
+HardwareCounters::Values HardwareCounters::Values::operator-(const Values& earlier) const
+{
+    auto delta = [](uint64_t later, uint64_t earlier) { return later > earlier ? later - earlier : 0; };
+    
+    Values difference;
+    difference.timeEnabled = delta(timeEnabled, earlier.timeEnabled);
+    difference.timeRunning = delta(timeRunning, earlier.timeRunning);
+    
+    // Nothing was counted if the group never got on the PMU
+    bool counted = difference.timeRunning > 0 || difference.timeEnabled == 0;
+    double scale = difference.timeRunning > 0 && difference.timeRunning < difference.timeEnabled ?
+                   static_cast<double>(difference.timeEnabled) / difference.timeRunning : 1.0;
+    
+    for (int i = 0; i < CounterCount; ++i)
+    {
+        difference.available[i] = available[i] && earlier.available[i] && counted;
+        if (difference.available[i])
+        {
+            difference.counts[i] = static_cast<uint64_t>(delta(counts[i], earlier.counts[i]) * scale);
+        }
+    }
+    
+    return difference;
+}
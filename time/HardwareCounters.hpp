@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+// CPU performance counters for the calling thread, read through
+// perf_event_open on Linux. The counters are opened as one group so the
+// kernel always schedules them together, and ratios like IPC compare counts
+// taken over the same time. A counter the kernel or hardware refuses
+// (perf_event_paranoid, containers, VMs without a PMU, other platforms) just
+// reads as unavailable and the rest still work.
+class HardwareCounters
+{
+public:
+    enum Counter
+    {
+        Cycles = 0,
+        Instructions,
+        L1DataMisses,
+        LastLevelCacheMisses,
+        BranchMisses,
+        
+        CounterCount    // Must remain last
+    };
+    
+    struct Values
+    {
+        uint64_t counts[CounterCount] = {};
+        bool available[CounterCount] = {};
+        
+        // How long the group was enabled and actually counting. They differ
+        // when the kernel multiplexed it with other events.
+        uint64_t timeEnabled = 0;
+        uint64_t timeRunning = 0;
+        
+        bool Has(Counter counter) const { return available[counter]; }
+        uint64_t Get(Counter counter) const { return counts[counter]; }
+        
+        // Instructions per cycle, 0 if either counter is unavailable
+        double GetIPC() const;
+        
+        // Events per 'per' units of work (e.g. misses per message), 0 if unavailable
+        double GetRate(Counter counter, uint64_t per) const;
+        
+        // The region between two Read()s: raw counts and times are subtracted
+        // first, clamped at 0, and the counts then scaled by the region's own
+        // enabled/running ratio. A region the group never ran in is unavailable.
+        Values operator-(const Values& earlier) const;
+    };
+    
+    HardwareCounters();
+    ~HardwareCounters();
+    
+    // True if at least one counter could be opened
+    bool IsAvailable() const;
+    
+    // Raw running totals since construction, not yet scaled for
+    // multiplexing. Subtract two readings to measure a region.
+    Values Read() const;
+    
+    static const char* GetName(Counter counter);
+    
+private:
+    HardwareCounters(const HardwareCounters&);  // Prevent copying
+    
+private:
+    int fds[CounterCount];
+    int leader = -1;                    // Group leader's fd, read for the whole group
+    int readOrder[CounterCount];        // Counters in the order they joined the group
+    int groupSize = 0;
+};
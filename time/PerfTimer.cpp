@@ -0,0 +1,133 @@
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "PerfTimer.hpp"
+
+namespace
+{
+struct ZoneTotals
+{
+    uint64_t calls = 0;
+    uint64_t nanoseconds = 0;
+    
+    // Only summed over calls that had the counter
+    uint64_t counts[HardwareCounters::CounterCount] = {};
+    uint64_t countedCalls[HardwareCounters::CounterCount] = {};
+};
+
+std::mutex s_zoneMutex;
+std::map<std::string, ZoneTotals> s_zones;
+}
+
+bool PerfTimer::s_useCounters = false;
+
+bool PerfTimer::EnableHardwareCounters(bool enable)
+{
+    s_useCounters = enable;
+    return !enable || GetThreadCounters() != nullptr;
+}
+
+HardwareCounters* PerfTimer::GetThreadCounters()
+{
+    // Opened on first use per thread and kept, opening costs a syscall per counter
+    thread_local std::unique_ptr<HardwareCounters> counters(new HardwareCounters());
+    return counters->IsAvailable() ? counters.get() : nullptr;
+}
+
+void PerfTimer::RecordZone(const std::string& name, uint64_t nanoseconds, const HardwareCounters::Values& counts)
+{
+    std::lock_guard<std::mutex> lock(s_zoneMutex);
+    
+    ZoneTotals& zone = s_zones[name];
+    ++zone.calls;
+    zone.nanoseconds += nanoseconds;
+    
+    for (int i = 0; i < HardwareCounters::CounterCount; ++i)
+    {
+        if (counts.available[i])
+        {
+            zone.counts[i] += counts.counts[i];
+            ++zone.countedCalls[i];
+        }
+    }
+}
+
+void PerfTimer::WriteReport(std::ostream& out)
+{
+    std::lock_guard<std::mutex> lock(s_zoneMutex);
+    
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    
+    out << std::left << std::setw(40) << "Zone" << std::right
+        << std::setw(8) << "Calls" << std::setw(12) << "Total ms" << std::setw(12) << "Avg ms"
+        << std::setw(8) << "IPC" << std::setw(10) << "L1D MPKI" << std::setw(10) << "LLC MPKI" << std::setw(10) << "Br MPKI" << std::endl;
+    out << std::fixed << std::setprecision(3);
+    
+    for (const auto& entry : s_zones)
+    {
+        const ZoneTotals& zone = entry.second;
+        
+        // Counters only mean anything if every call had them
+        HardwareCounters::Values counts;
+        for (int i = 0; i < HardwareCounters::CounterCount; ++i)
+        {
+            counts.available[i] = zone.countedCalls[i] == zone.calls;
+            counts.counts[i] = zone.counts[i];
+        }
+        
+        out << std::left << std::setw(40) << entry.first.substr(0, 39) << std::right
+            << std::setw(8) << zone.calls
+            << std::setw(12) << zone.nanoseconds / 1e6
+            << std::setw(12) << zone.nanoseconds / 1e6 / zone.calls;
+        
+        if (counts.Has(HardwareCounters::Cycles) && counts.Has(HardwareCounters::Instructions))
+        {
+            out << std::setw(8) << std::setprecision(2) << counts.GetIPC() << std::setprecision(3);
+        }
+        else
+        {
+            out << std::setw(8) << "n/a";
+        }
+        
+        const HardwareCounters::Counter misses[] = { HardwareCounters::L1DataMisses, HardwareCounters::LastLevelCacheMisses, HardwareCounters::BranchMisses };
+        for (HardwareCounters::Counter counter : misses)
+        {
+            uint64_t kiloInstructions = counts.Get(HardwareCounters::Instructions) / 1000;
+            if (counts.Has(counter) && counts.Has(HardwareCounters::Instructions) && kiloInstructions > 0)
+            {
+                out << std::setw(10) << counts.GetRate(counter, kiloInstructions);
+            }
+            else
+            {
+                out << std::setw(10) << "n/a";
+            }
+        }
+        out << std::endl;
+    }
+    
+    out.flags(flags);
+    out.precision(precision);
+}
+
+std::vector<PerfTimer::ZoneTotal> PerfTimer::GetZoneTotals()
+{
+    std::lock_guard<std::mutex> lock(s_zoneMutex);
+    
+    std::vector<ZoneTotal> totals;
+    totals.reserve(s_zones.size());
+    for (const auto& entry : s_zones)
+    {
+        totals.push_back(ZoneTotal{ entry.first, entry.second.calls, entry.second.nanoseconds });
+    }
+    
+    return totals;
+}
+
+void PerfTimer::ResetReport()
+{
+    std::lock_guard<std::mutex> lock(s_zoneMutex);
+    s_zones.clear();
+}
@@ -1,9 +1,15 @@
+#pragma once
+
 #include <iostream>
 #include <mach/mach.h>
 #include <mach/mach_time.h>
 #include <unistd.h>
 
 #include <chrono>
+#include <string>
+#include <vector>
+#include "HardwareCounters.hpp"
+#include "SamplingProfiler.hpp"
 
 typedef std::chrono::high_resolution_clock Clock;
 typedef std::chrono::time_point<std::chrono::high_resolution_clock> Timestamp;
@@ -14,6 +20,16 @@ public:
     PerfTimer(const char* timerName)
     {
         m_name = std::string(timerName);
+        SamplingProfiler::PushZone(m_name.c_str());
+        
+        if (s_useCounters)
+        {
+            m_counters = GetThreadCounters();
+            if (m_counters != nullptr)
+            {
+                m_startCounts = m_counters->Read();
+            }
+        }
         
         // Start the timer
         m_startTime = Clock::now();
@@ -23,14 +39,57 @@ public:
     {
         Timestamp endTime = Clock::now();
         std::chrono::nanoseconds elapsed = (endTime - m_startTime);
+        SamplingProfiler::PopZone();
+        
+        HardwareCounters::Values counts;
+        if (m_counters != nullptr)
+        {
+            counts = m_counters->Read() - m_startCounts;
+        }
         
         // Output timer duration in milliseconds
-        std::cout << m_name.c_str() << ": " << (double)elapsed.count() / 1000000 << " milliseconds" << std::endl;
+        std::cout << m_name.c_str() << ": " << (double)elapsed.count() / 1000000 << " milliseconds";
+        if (counts.Has(HardwareCounters::Cycles) && counts.Has(HardwareCounters::Instructions))
+        {
+            std::cout << " (IPC " << counts.GetIPC() << ")";
+        }
+        std::cout << std::endl;
+        
+        RecordZone(m_name, elapsed.count(), counts);
     }
     
+    // Reads hardware counters (see HardwareCounters) around every timer from
+    // now on, each thread counting its own zones. Returns false if the
+    // counters can't be opened here, timers then record time only.
+    static bool EnableHardwareCounters(bool enable);
+    
+    // Every timer so far aggregated by name: calls, time, IPC and misses per
+    // thousand instructions. Counter columns read n/a where they weren't
+    // available.
+    static void WriteReport(std::ostream& out);
+    static void ResetReport();
+    
+    struct ZoneTotal
+    {
+        std::string name;
+        uint64_t calls;
+        uint64_t nanoseconds;
+    };
+    
+    // Copy of the aggregated times, safe to take from any thread
+    static std::vector<ZoneTotal> GetZoneTotals();
+    
+private:
+    static HardwareCounters* GetThreadCounters();
+    static void RecordZone(const std::string& name, uint64_t nanoseconds, const HardwareCounters::Values& counts);
+    
 private:
     Timestamp m_startTime;
     std::string m_name;
+    HardwareCounters* m_counters = nullptr;
+    HardwareCounters::Values m_startCounts;
+    
+    static bool s_useCounters;
 };
 
 #ifndef SHIPPING_BUILD
@@ -49,4 +108,4 @@ private:
 #define CreateFcnTimer ((void)0)
 #define ScopeTimer(x) ((void)0)
 
-#endif
\ No newline at end of file
+#endif
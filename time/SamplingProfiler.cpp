@@ -0,0 +1,298 @@
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <map>
+#include <memory>
+#include <pthread.h>
+#include <string>
+#include <sys/time.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+#include "SamplingProfiler.hpp"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#endif
+
+namespace
+{
+const int MaxFrames = 48;
+const int MaxZones = 8;
+const int MaxZoneName = 48;
+
+// TakeSample, the handler and the signal trampoline
+const int SkippedFrames = 3;
+
+struct Sample
+{
+    void* frames[MaxFrames];
+    int frameCount;
+    int zoneCount;
+    char zones[MaxZones][MaxZoneName];
+};
+
+std::atomic<bool> s_running{ false };
+std::atomic<size_t> s_nextSample{ 0 };
+std::atomic<size_t> s_dropped{ 0 };
+
+// Allocated up front, the handler can't allocate
+std::unique_ptr<Sample[]> s_samples;
+size_t s_capacity = 0;
+
+pthread_t s_profiledThread;
+struct sigaction s_previousAction;
+
+#ifdef __linux__
+timer_t s_timer;
+#endif
+
+void OnSignal(int, siginfo_t*, void*);
+}
+
+// Kept out of line so the frames to skip are always the same
+__attribute__((noinline)) void SamplingProfiler::TakeSample()
+{
+    size_t index = s_nextSample.fetch_add(1, std::memory_order_relaxed);
+    if (index >= s_capacity)
+    {
+        s_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    Sample& sample = s_samples[index];
+    sample.frameCount = backtrace(sample.frames, MaxFrames);
+    
+    // Zones are copied, the timers that own the names may be gone by the time
+    // the profile is written
+    int depth = t_zoneDepth.load(std::memory_order_relaxed);
+    std::atomic_signal_fence(std::memory_order_acquire);
+    sample.zoneCount = 0;
+    for (int i = 0; i < depth && i < MaxZoneDepth && sample.zoneCount < MaxZones; ++i)
+    {
+        strncpy(sample.zones[sample.zoneCount], t_zones[i], MaxZoneName - 1);
+        sample.zones[sample.zoneCount][MaxZoneName - 1] = '\0';
+        ++sample.zoneCount;
+    }
+}
+
+namespace
+{
+void OnSignal(int, siginfo_t*, void*)
+{
+    // setitimer's SIGPROF can land on any thread
+    if (!s_running.load(std::memory_order_relaxed) || !pthread_equal(pthread_self(), s_profiledThread))
+    {
+        return;
+    }
+    
+    int savedErrno = errno;
+    SamplingProfiler::TakeSample();
+    errno = savedErrno;
+}
+
+// "[zone]" or a demangled function name, without the ';' that separates frames
+std::string SanitizeFrame(std::string name)
+{
+    for (char& c : name)
+    {
+        if (c == ';')
+        {
+            c = ':';
+        }
+    }
+    
+    return name;
+}
+
+std::string Symbolize(void* address)
+{
+    Dl_info info;
+    if (dladdr(address, &info) == 0)
+    {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%p", address);
+        return buffer;
+    }
+    
+    if (info.dli_sname != nullptr)
+    {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        std::string name = status == 0 ? demangled : info.dli_sname;
+        free(demangled);
+        return SanitizeFrame(name);
+    }
+    
+    // No symbol, fall back to the module and offset
+    const char* module = info.dli_fname != nullptr ? info.dli_fname : "??";
+    const char* slash = strrchr(module, '/');
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s+0x%zx", slash != nullptr ? slash + 1 : module,
+             static_cast<size_t>(static_cast<char*>(address) - static_cast<char*>(info.dli_fbase)));
+    return buffer;
+}
+}
+
+bool SamplingProfiler::Start(int intervalMicroseconds, size_t maxSamples)
+{
+    if (IsRunning() || intervalMicroseconds <= 0)
+    {
+        return false;
+    }
+    
+    // backtrace loads its unwinder on first use, which isn't safe to do in a handler
+    void* warmup[1];
+    backtrace(warmup, 1);
+    
+    s_samples.reset(new Sample[maxSamples]);
+    s_capacity = maxSamples;
+    s_nextSample = 0;
+    s_dropped = 0;
+    s_profiledThread = pthread_self();
+    
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = OnSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, &s_previousAction) != 0)
+    {
+        return false;
+    }
+    
+    s_running = true;
+    
+#ifdef __linux__
+    // Counts this thread's CPU time only and signals only this thread
+    sigevent event;
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+    
+    itimerspec interval;
+    interval.it_interval.tv_sec = intervalMicroseconds / 1000000;
+    interval.it_interval.tv_nsec = (intervalMicroseconds % 1000000) * 1000;
+    interval.it_value = interval.it_interval;
+    
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &s_timer) != 0)
+    {
+        s_running = false;
+        sigaction(SIGPROF, &s_previousAction, nullptr);
+        return false;
+    }
+    timer_settime(s_timer, 0, &interval, nullptr);
+#else
+    // Process CPU time, samples landing on other threads are ignored
+    itimerval interval;
+    interval.it_interval.tv_sec = intervalMicroseconds / 1000000;
+    interval.it_interval.tv_usec = intervalMicroseconds % 1000000;
+    interval.it_value = interval.it_interval;
+    setitimer(ITIMER_PROF, &interval, nullptr);
+#endif
+    
+    return true;
+}
+
+void SamplingProfiler::Stop()
+{
+    if (!IsRunning())
+    {
+        return;
+    }
+    
+#ifdef __linux__
+    timer_delete(s_timer);
+#else
+    itimerval off;
+    memset(&off, 0, sizeof(off));
+    setitimer(ITIMER_PROF, &off, nullptr);
+#endif
+    
+    s_running = false;
+    sigaction(SIGPROF, &s_previousAction, nullptr);
+}
+
+bool SamplingProfiler::IsRunning()
+{
+    return s_running.load(std::memory_order_relaxed);
+}
+
+size_t SamplingProfiler::GetSampleCount()
+{
+    size_t taken = s_nextSample.load(std::memory_order_relaxed);
+    return taken < s_capacity ? taken : s_capacity;
+}
+
+size_t SamplingProfiler::GetDroppedCount()
+{
+    return s_dropped.load(std::memory_order_relaxed);
+}
+
+void SamplingProfiler::WriteCollapsed(std::ostream& out)
+{
+    if (IsRunning())
+    {
+        return;
+    }
+    
+    std::unordered_map<void*, std::string> symbols;
+    std::map<std::string, uint64_t> stacks;
+    
+    size_t count = GetSampleCount();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Sample& sample = s_samples[i];
+        
+        std::string stack;
+        for (int zone = 0; zone < sample.zoneCount; ++zone)
+        {
+            stack += "[" + SanitizeFrame(sample.zones[zone]) + "];";
+        }
+        
+        // Root first. Every frame but the interrupted one is a return address,
+        // which can point past the end of its caller, so look up the byte before.
+        for (int frame = sample.frameCount - 1; frame >= SkippedFrames; --frame)
+        {
+            void* address = sample.frames[frame];
+            void* lookup = frame > SkippedFrames ? static_cast<char*>(address) - 1 : address;
+            
+            auto it = symbols.find(lookup);
+            if (it == symbols.end())
+            {
+                it = symbols.emplace(lookup, Symbolize(lookup)).first;
+            }
+            
+            stack += it->second;
+            stack += ';';
+        }
+        
+        if (!stack.empty())
+        {
+            stack.pop_back();
+            ++stacks[stack];
+        }
+    }
+    
+    for (const auto& entry : stacks)
+    {
+        out << entry.first << " " << entry.second << "\n";
+    }
+}
+
+void SamplingProfiler::Clear()
+{
+    if (!IsRunning())
+    {
+        s_nextSample = 0;
+        s_dropped = 0;
+    }
+}
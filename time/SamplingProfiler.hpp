@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+
+// Statistical profiler for the simulation thread. A CPU-time timer raises
+// SIGPROF on the thread that called Start(), and the handler records that
+// thread's native call stack along with whichever ScopeTimer zones are active
+// on it. Nothing has to be annotated for a function to show up, the zones just
+// add context.
+//
+// Stacks are resolved with dladdr, so functions in the executable only get
+// names if it exports its symbols (link with -rdynamic on Linux), otherwise
+// they show as module+offset.
+class SamplingProfiler
+{
+public:
+    // Starts sampling the calling thread every 'intervalMicroseconds' of CPU
+    // time it uses, keeping up to 'maxSamples'. Returns false if a profile is
+    // already running or the timer couldn't be created.
+    static bool Start(int intervalMicroseconds = 1000, size_t maxSamples = 20000);
+    static void Stop();
+    static bool IsRunning();
+    
+    static size_t GetSampleCount();
+    static size_t GetDroppedCount();
+    
+    // One line per distinct stack in the folded format flame graph tools read:
+    // frames from the root down separated by ';', then a space and the number
+    // of samples. Active zones come first, as "[zone name]". Call after Stop().
+    static void WriteCollapsed(std::ostream& out);
+    
+    // Drops the samples taken so far
+    static void Clear();
+    
+    // Zone stack of the calling thread, kept by PerfTimer. Safe for the
+    // signal handler to read at any point.
+    static void PushZone(const char* name)
+    {
+        int depth = t_zoneDepth.load(std::memory_order_relaxed);
+        if (depth < MaxZoneDepth)
+        {
+            t_zones[depth] = name;
+        }
+        std::atomic_signal_fence(std::memory_order_release);
+        t_zoneDepth.store(depth + 1, std::memory_order_relaxed);
+    }
+    
+    static void PopZone()
+    {
+        t_zoneDepth.store(t_zoneDepth.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    }
+    
+    static const int MaxZoneDepth = 16;
+    
+    // Records the calling thread's stack, from the SIGPROF handler only
+    static void TakeSample();
+    
+private:
+    static inline thread_local const char* t_zones[MaxZoneDepth];
+    static inline thread_local std::atomic<int> t_zoneDepth{ 0 };
+};